@@ -0,0 +1,29 @@
+#include "BitArena.h"
+
+
+BitArena::BitArena() : next(NULL), end(NULL)
+{
+}
+
+
+BitArena::~BitArena()
+{
+	for (char* block : blocks) {
+		delete[] block;
+	}
+}
+
+
+void* BitArena::allocate_block(size_t size, size_t alignment)
+{
+	// Objects larger than a block get a block of their own, the current block stays in use.
+	size_t capacity = size + alignment > block_size ? size + alignment : block_size;
+	// new[] returns memory aligned for any fundamental type.
+	char* block = new char[capacity];
+	blocks.push_back(block);
+	if (capacity == block_size) {
+		next = block + size;
+		end = block + capacity;
+	}
+	return block;
+}
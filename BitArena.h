@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+
+/// <summary>
+/// A bump allocator for the nodes of one program. Objects are placed in large blocks and
+/// are never destroyed individually, all blocks are released at once with the arena.
+/// Only trivially destructible types can be created, their destructors would never run.
+/// </summary>
+class BitArena
+{
+public:
+	static const size_t block_size = 64 * 1024;
+
+	BitArena();
+	~BitArena();
+	BitArena(const BitArena&) = delete;
+	BitArena& operator=(const BitArena&) = delete;
+
+	template<class T> T* create() {
+		static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed.");
+		return new (allocate(sizeof(T), alignof(T))) T();
+	}
+
+	inline void* allocate(size_t size, size_t alignment) {
+		size_t padding = (alignment - (size_t)next % alignment) % alignment;
+		if (next == NULL || size + padding > (size_t)(end - next)) {
+			return allocate_block(size, alignment);
+		}
+		void* result = next + padding;
+		next += padding + size;
+		return result;
+	}
+
+private:
+	std::vector<char*> blocks;
+	char* next;
+	char* end;
+
+	void* allocate_block(size_t size, size_t alignment);
+};
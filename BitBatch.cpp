@@ -0,0 +1,235 @@
+#include "BitBatch.h"
+#include <cstdio>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include "BitNodes.h"
+#include "BitParser.h"
+#include "BitReader.h"
+#include "BitError.h"
+#include "BitCompiled.h"
+
+using namespace std;
+
+
+BitBatch::BitBatch(const BitOptions& options, int thread_count) : options(options), pool(thread_count)
+{
+}
+
+
+void BitBatch::add(const string& program_path, const string& input_path)
+{
+	auto entry = source_indexes.try_emplace(program_path, sources.size());
+	if (entry.second) {
+		sources.emplace_back();
+		sources.back().path = program_path;
+	}
+	runs.push_back({ entry.first->second, input_path, string(), false });
+}
+
+
+bool BitBatch::add_manifest(const string& path)
+{
+	string manifest;
+	if (!read_file(path, manifest)) {
+		return false;
+	}
+	filesystem::path directory = filesystem::path(path).parent_path();
+	istringstream lines(manifest);
+	string line;
+	while (getline(lines, line)) {
+		istringstream fields(line);
+		string program_path, input_path;
+		if (!(fields >> program_path) || program_path[0] == '#') {
+			continue;
+		}
+		if (fields >> input_path) {
+			input_path = (directory / input_path).string();
+		}
+		add((directory / program_path).string(), input_path);
+	}
+	return true;
+}
+
+
+bool BitBatch::add_directory(const string& path)
+{
+	error_code error;
+	vector<string> files;
+	for (const filesystem::directory_entry& entry : filesystem::directory_iterator(path, error)) {
+		if (entry.is_regular_file()) {
+			files.push_back(entry.path().string());
+		}
+	}
+	if (error) {
+		return false;
+	}
+	sort(files.begin(), files.end());
+	for (const string& file : files) {
+		add(file, string());
+	}
+	return true;
+}
+
+
+bool BitBatch::run()
+{
+	pool.run(sources.size(), [this](size_t index) { prepare(sources[index]); });
+	// Every task is a single run or a group of runs of a sliced program.
+	vector<vector<size_t>> tasks;
+	vector<vector<size_t>> sliced_runs(sources.size());
+	for (size_t index = 0; index < runs.size(); index++) {
+		const Source& source = sources[runs[index].source];
+		if (source.program != NULL && source.program->sliced != NULL) {
+			sliced_runs[runs[index].source].push_back(index);
+		}
+		else {
+			tasks.push_back({ index });
+		}
+	}
+	for (const vector<size_t>& group : sliced_runs) {
+		for (size_t first = 0; first < group.size(); first += BitSlicedProgram::max_lanes) {
+			size_t last = min(group.size(), first + BitSlicedProgram::max_lanes);
+			tasks.emplace_back(group.begin() + first, group.begin() + last);
+		}
+	}
+	pool.run(tasks.size(), [this, &tasks](size_t index) {
+		const vector<size_t>& task = tasks[index];
+		if (sources[runs[task[0]].source].program != NULL && sources[runs[task[0]].source].program->sliced != NULL) {
+			execute_sliced(task);
+		}
+		else {
+			execute(runs[task[0]]);
+		}
+	});
+	return none_of(runs.begin(), runs.end(), [](const Run& run) { return run.failed; });
+}
+
+
+void BitBatch::print(BitWriter& output) const
+{
+	for (const Run& run : runs) {
+		output.write(run.result.data(), run.result.size());
+		output.put('\n');
+	}
+	output.flush();
+}
+
+
+void BitBatch::prepare(Source& source)
+{
+	string text;
+	if (!read_file(source.path, text)) {
+		source.error = "ERROR: The file " + source.path + " can't be opened.";
+		return;
+	}
+	// A compiled file has no input after its program. A batch runs one program per source, so a file with
+	// more programs is refused rather than running only the first of them.
+	try {
+		if (BitCompiled::is_compiled(text.data(), text.data() + text.size())) {
+			vector<unique_ptr<CodeNode>> programs;
+			if (!BitCompiled::load(text.data(), text.data() + text.size(), programs)) {
+				source.error = "ERROR: The compiled file " + source.path + " is damaged or of another version.";
+				return;
+			}
+			if (programs.size() != 1) {
+				source.error = "ERROR: The compiled file " + source.path + " holds " + to_string(programs.size()) + " programs, a batch runs one per source.";
+				return;
+			}
+			source.program.reset(new BitProgram(programs[0].release(), options));
+			return;
+		}
+		BitReader reader(text.data(), text.data() + text.size());
+		BitParser parser(reader);
+		source.program.reset(new BitProgram(parser.parse(options.optimize), options));
+		source.input = text.substr(min((size_t)reader.offset(), text.size()));
+	}
+	catch (const BitParserError& error) {
+		source.error = "ERROR: " + string(error.what()) + ". Position " + to_string(error.position);
+	}
+	catch (const exception& error) {
+		source.error = "ERROR: " + string(error.what());
+	}
+}
+
+
+void BitBatch::execute(Run& run)
+{
+	const Source& source = sources[run.source];
+	if (source.program == NULL) {
+		run.result = source.error;
+		run.failed = true;
+		return;
+	}
+	string file_input;
+	const string* input = &source.input;
+	if (!run.input_path.empty()) {
+		if (!read_file(run.input_path, file_input)) {
+			run.result = "ERROR: The file " + run.input_path + " can't be opened.";
+			run.failed = true;
+			return;
+		}
+		input = &file_input;
+	}
+	BitReader reader(input->data(), input->data() + input->size());
+	BitWriter writer(run.result);
+	BitInterpreter interpreter(reader, writer, options);
+	try {
+		interpreter.run(*source.program);
+		writer.flush();
+	}
+	catch (const BitLimitError& error) {
+		writer.flush();
+		run.result += "STOPPED: " + string(error.what());
+		run.failed = true;
+	}
+	catch (const exception& error) {
+		writer.flush();
+		run.result += "RUNTIME ERROR: " + string(error.what());
+		run.failed = true;
+	}
+}
+
+
+void BitBatch::execute_sliced(const vector<size_t>& group)
+{
+	const Source& source = sources[runs[group[0]].source];
+	vector<string> file_inputs(group.size());
+	vector<const string*> inputs;
+	vector<Run*> lanes;
+	for (size_t i = 0; i < group.size(); i++) {
+		Run& run = runs[group[i]];
+		if (!run.input_path.empty() && !read_file(run.input_path, file_inputs[i])) {
+			run.result = "ERROR: The file " + run.input_path + " can't be opened.";
+			run.failed = true;
+			continue;
+		}
+		inputs.push_back(run.input_path.empty() ? &source.input : &file_inputs[i]);
+		lanes.push_back(&run);
+	}
+	vector<BitSlicedProgram::Result> results;
+	source.program->sliced->run(inputs, options.read_ascii, options.print_ascii, results);
+	for (size_t lane = 0; lane < lanes.size(); lane++) {
+		lanes[lane]->result.swap(results[lane].output);
+		if (!results[lane].error.empty()) {
+			lanes[lane]->result += "RUNTIME ERROR: " + results[lane].error;
+			lanes[lane]->failed = true;
+		}
+	}
+}
+
+
+bool BitBatch::read_file(const string& path, string& contents)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		return false;
+	}
+	char buffer[1 << 16];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		contents.append(buffer, size);
+	}
+	fclose(file);
+	return true;
+}
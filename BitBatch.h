@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "BitInterpreter.h"
+#include "BitProgram.h"
+#include "BitThreadPool.h"
+#include "BitWriter.h"
+
+/// <summary>
+/// Runs programs against many inputs in parallel. Every program file is parsed and compiled once,
+/// the runs are spread over a thread pool and each one gets its own interpreter.
+/// A run without an input file reads the source after the program's ; like the standard input.
+/// With bit slicing the runs of a program are run together, up to BitSlicedProgram::max_lanes at once.
+/// The results are kept in the order the runs were added.
+/// </summary>
+class BitBatch
+{
+public:
+	BitBatch(const BitOptions& options, int thread_count = 0);
+	BitBatch(const BitBatch&) = delete;
+	BitBatch& operator=(const BitBatch&) = delete;
+
+	// An input path that is empty means the run reads the rest of the source.
+	void add(const std::string& program_path, const std::string& input_path);
+	// Every line of the manifest is a program path and an optional input path, relative to the manifest.
+	// Empty lines and lines starting with # are skipped. Returns false if the manifest can't be read.
+	bool add_manifest(const std::string& path);
+	// Adds a run for every file of the directory, in the order of the file names.
+	bool add_directory(const std::string& path);
+	size_t size() const { return runs.size(); };
+
+	// Returns false if any program failed.
+	bool run();
+	// Writes the output of every run, or its error, on a line of its own.
+	void print(BitWriter& output) const;
+
+private:
+	struct Source {
+		std::string path;
+		std::unique_ptr<BitProgram> program;
+		// The characters after the program.
+		std::string input;
+		// The syntax error, if the program couldn't be parsed.
+		std::string error;
+	};
+
+	struct Run {
+		size_t source;
+		std::string input_path;
+		std::string result;
+		bool failed;
+	};
+
+	BitOptions options;
+	BitThreadPool pool;
+	std::vector<Source> sources;
+	std::unordered_map<std::string, size_t> source_indexes;
+	std::vector<Run> runs;
+
+	void prepare(Source& source);
+	void execute(Run& run);
+	void execute_sliced(const std::vector<size_t>& group);
+	static bool read_file(const std::string& path, std::string& contents);
+};
@@ -0,0 +1,281 @@
+#include "BitBenchmark.h"
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <iomanip>
+#include "BitParser.h"
+#include "BitProgram.h"
+#include "BitNodes.h"
+#include "BitProfile.h"
+#include "BitReader.h"
+#include "BitWriter.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// The generated programs are sized to run for some milliseconds in the tree walker.
+static const int straight_line_count = 20000;
+static const int counter_bit_count = 16;
+
+static double seconds_since(steady_clock::time_point start) {
+	return duration<double>(steady_clock::now() - start).count();
+}
+
+// A number in the words of the language, the most significant bit first.
+static string number_words(int number) {
+	string words = (number & 1) ? "ONE" : "ZERO";
+	for (number >>= 1; number != 0; number >>= 1) {
+		words = ((number & 1) ? "ONE " : "ZERO ") + words;
+	}
+	return words;
+}
+
+static string nand_of_nands(int a, int b, int c, int d) {
+	return "OPEN PARENTHESIS VARIABLE " + number_words(a) + " NAND VARIABLE " + number_words(b) + " CLOSE PARENTHESIS NAND "
+		"OPEN PARENTHESIS VARIABLE " + number_words(c) + " NAND VARIABLE " + number_words(d) + " CLOSE PARENTHESIS";
+}
+
+
+BitBenchmark::BitBenchmark(const BitOptions& options, double min_seconds) : options(options), min_seconds(min_seconds)
+{
+}
+
+
+void BitBenchmark::add(const string& name, const string& source, const string& input)
+{
+	Workload workload = Workload();
+	workload.name = name;
+	workload.source = source;
+	workload.input = input;
+	workloads.push_back(workload);
+}
+
+
+void BitBenchmark::add_generated()
+{
+	add("straight " + to_string(straight_line_count), straight_program(straight_line_count), "");
+	add("counter " + to_string(counter_bit_count), counter_program(counter_bit_count), "");
+}
+
+
+string BitBenchmark::straight_program(int line_count)
+{
+	string source;
+	for (int line = 0; line < line_count; line++) {
+		source += "LINE NUMBER " + number_words(line) + " CODE VARIABLE " + number_words(line % 8) + " EQUALS "
+			+ nand_of_nands((line + 1) % 8, (line + 2) % 8, (line + 3) % 8, (line + 4) % 8);
+		if (line + 1 < line_count) {
+			source += " GOTO " + number_words(line + 1);
+		}
+		source += "\n";
+	}
+	return source;
+}
+
+
+string BitBenchmark::counter_program(int bit_count)
+{
+	// Bit i of the counter is variable i. Line 3i+1 tests it, 3i+2 sets it and continues with the work,
+	// 3i+3 clears it and carries into the next bit. The work line comes last.
+	int work_line = 3 * bit_count + 1;
+	int work_variable = bit_count;
+	string source;
+	for (int bit = 0; bit < bit_count; bit++) {
+		int test_line = 3 * bit + 1;
+		source += "LINE NUMBER " + number_words(test_line) + " CODE THE JUMP REGISTER EQUALS VARIABLE " + number_words(bit)
+			+ " GOTO " + number_words(test_line + 1) + " IF THE JUMP REGISTER IS ZERO GOTO " + number_words(test_line + 2)
+			+ " IF THE JUMP REGISTER IS ONE\n";
+		source += "LINE NUMBER " + number_words(test_line + 1) + " CODE VARIABLE " + number_words(bit) + " EQUALS ONE GOTO "
+			+ number_words(work_line) + "\n";
+		source += "LINE NUMBER " + number_words(test_line + 2) + " CODE VARIABLE " + number_words(bit) + " EQUALS ZERO";
+		if (bit + 1 < bit_count) {
+			source += " GOTO " + number_words(test_line + 3);
+		}
+		source += "\n";
+	}
+	source += "LINE NUMBER " + number_words(work_line) + " CODE VARIABLE " + number_words(work_variable) + " EQUALS "
+		+ nand_of_nands(0, 1, work_variable, 2 % bit_count) + " GOTO ONE\n";
+	return source;
+}
+
+
+void BitBenchmark::run()
+{
+	for (Workload& workload : workloads) {
+		count(workload);
+		if (!workload.error.empty()) {
+			continue;
+		}
+		measure_parse(workload);
+		for (int backend = 0; backend < BACKEND_COUNT; backend++) {
+			measure(workload, (Backend)backend);
+		}
+	}
+}
+
+
+// Runs the unoptimized syntax tree once with a profile. The NANDs and the printed and read bits of every
+// line are counted in its bytecode.
+void BitBenchmark::count(Workload& workload) const
+{
+	BitOptions counting = options;
+	counting.use_tree_walker = true;
+	counting.use_jit = false;
+	try {
+		BitReader source(workload.source.data(), workload.source.data() + workload.source.size());
+		BitParser parser(source);
+		BitProgram program(parser.parse(false), counting);
+		BytecodeProgram bytecode;
+		program.code->compile(bytecode, false, false);
+		vector<BitMetrics::Work> work = BitMetrics::weigh(bytecode);
+
+		BitProfile profile(*program.code);
+		BitReader input(workload.input.data(), workload.input.data() + workload.input.size());
+		string output;
+		BitWriter writer(output);
+		BitInterpreter interpreter(input, writer, counting);
+		interpreter.profile = &profile;
+		interpreter.run(program);
+
+		for (size_t index = 0; index < profile.lines.size(); index++) {
+			uint64_t runs = profile.lines[index].runs;
+			workload.lines += runs;
+			workload.nands += runs * work[index].nands;
+			workload.io_bits += runs * work[index].io_bits;
+		}
+		for (const auto& entry : profile.memory) {
+			workload.memory_accesses += entry.second.reads + entry.second.writes;
+		}
+	}
+	catch (const exception& error) {
+		workload.error = error.what();
+	}
+}
+
+
+void BitBenchmark::measure_parse(Workload& workload) const
+{
+	uint64_t parses = 0;
+	steady_clock::time_point start = steady_clock::now();
+	double elapsed;
+	do {
+		BitReader source(workload.source.data(), workload.source.data() + workload.source.size());
+		BitParser parser(source);
+		unique_ptr<CodeNode> code(parser.parse(options.optimize));
+		parses++;
+		elapsed = seconds_since(start);
+	} while (elapsed < min_seconds);
+	workload.parse_seconds = elapsed / parses;
+}
+
+
+void BitBenchmark::measure(Workload& workload, Backend backend) const
+{
+	Measurement& measurement = workload.measurements[backend];
+	measurement = Measurement();
+	BitOptions measured = options;
+	measured.use_tree_walker = backend == BACKEND_TREE_WALKER;
+	measured.use_jit = backend == BACKEND_JIT;
+	try {
+		BitReader source(workload.source.data(), workload.source.data() + workload.source.size());
+		BitParser parser(source);
+		CodeNode* code = parser.parse(options.optimize);
+		steady_clock::time_point prepared = steady_clock::now();
+		BitProgram program(code, measured);
+		measurement.prepare_seconds = seconds_since(prepared);
+		if (backend == BACKEND_JIT && program.jit == NULL) {
+			return;
+		}
+		measurement.measured = true;
+		steady_clock::time_point start = steady_clock::now();
+		do {
+			BitReader input(workload.input.data(), workload.input.data() + workload.input.size());
+			string output;
+			BitWriter writer(output);
+			BitInterpreter interpreter(input, writer, measured);
+			interpreter.run(program);
+			writer.flush();
+			measurement.runs++;
+			measurement.run_seconds = seconds_since(start);
+		} while (measurement.run_seconds < min_seconds);
+	}
+	catch (const exception& error) {
+		measurement.error = error.what();
+	}
+}
+
+
+const char* BitBenchmark::backend_name(Backend backend)
+{
+	static const char* const names[] = { "tree walker", "bytecode", "jit" };
+	return names[backend];
+}
+
+
+void BitBenchmark::write_text(ostream& out) const
+{
+	out << left << setw(16) << "program" << setw(13) << "backend" << right << setw(11) << "parse ms" << setw(11) << "run ms"
+		<< setw(11) << "Mlines/s" << setw(11) << "MNANDs/s" << setw(11) << "Mmem/s" << setw(11) << "Mbits/s" << "\n";
+	out << fixed << setprecision(3);
+	for (const Workload& workload : workloads) {
+		if (!workload.error.empty()) {
+			out << left << setw(16) << workload.name << "ERROR: " << workload.error << "\n";
+			continue;
+		}
+		for (int backend = 0; backend < BACKEND_COUNT; backend++) {
+			const Measurement& measurement = workload.measurements[backend];
+			out << left << setw(16) << workload.name << setw(13) << backend_name((Backend)backend) << right;
+			if (!measurement.error.empty()) {
+				out << "ERROR: " << measurement.error << "\n";
+				continue;
+			}
+			if (!measurement.measured) {
+				out << "not supported\n";
+				continue;
+			}
+			double runs_per_second = measurement.runs / measurement.run_seconds;
+			out << setw(11) << workload.parse_seconds * 1000 << setw(11) << measurement.run_seconds * 1000 / measurement.runs
+				<< setw(11) << workload.lines * runs_per_second / 1e6 << setw(11) << workload.nands * runs_per_second / 1e6
+				<< setw(11) << workload.memory_accesses * runs_per_second / 1e6 << setw(11) << workload.io_bits * runs_per_second / 1e6
+				<< "\n";
+		}
+	}
+}
+
+
+void BitBenchmark::write_json(ostream& out) const
+{
+	out << setprecision(9) << "{\"workloads\":[";
+	for (size_t i = 0; i < workloads.size(); i++) {
+		const Workload& workload = workloads[i];
+		// The names and the error messages contain no characters that need escaping.
+		out << (i > 0 ? "," : "") << "{\"name\":\"" << workload.name << "\",\"source_bytes\":" << workload.source.size();
+		if (!workload.error.empty()) {
+			out << ",\"error\":\"" << workload.error << "\"}";
+			continue;
+		}
+		out << ",\"parse_seconds\":" << workload.parse_seconds << ",\"lines\":" << workload.lines << ",\"nands\":" << workload.nands
+			<< ",\"memory_accesses\":" << workload.memory_accesses << ",\"io_bits\":" << workload.io_bits << ",\"backends\":[";
+		for (int backend = 0; backend < BACKEND_COUNT; backend++) {
+			const Measurement& measurement = workload.measurements[backend];
+			out << (backend > 0 ? "," : "") << "{\"backend\":\"" << backend_name((Backend)backend) << "\"";
+			if (!measurement.error.empty()) {
+				out << ",\"error\":\"" << measurement.error << "\"}";
+				continue;
+			}
+			out << ",\"supported\":" << (measurement.measured ? "true" : "false");
+			if (measurement.measured) {
+				double runs_per_second = measurement.runs / measurement.run_seconds;
+				out << ",\"prepare_seconds\":" << measurement.prepare_seconds << ",\"runs\":" << measurement.runs
+					<< ",\"run_seconds\":" << measurement.run_seconds / measurement.runs
+					<< ",\"lines_per_second\":" << workload.lines * runs_per_second
+					<< ",\"nands_per_second\":" << workload.nands * runs_per_second
+					<< ",\"memory_accesses_per_second\":" << workload.memory_accesses * runs_per_second
+					<< ",\"io_bits_per_second\":" << workload.io_bits * runs_per_second;
+			}
+			out << "}";
+		}
+		out << "]}";
+	}
+	out << "]}\n";
+}
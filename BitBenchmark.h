@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "BitInterpreter.h"
+
+/// <summary>
+/// Measures the interpreters on a set of programs: how long parsing takes, and how many lines, NANDs,
+/// memory accesses and printed or read bits every backend runs per second.
+/// The work of a program is counted once by a profiled run of its unoptimized syntax tree, so the rates
+/// of all backends and of optimized and unoptimized programs are comparable.
+/// Every measurement repeats the parse or the run until it took at least the minimum time.
+/// </summary>
+class BitBenchmark
+{
+public:
+	BitBenchmark(const BitOptions& options, double min_seconds = 0.2);
+	BitBenchmark(const BitBenchmark&) = delete;
+	BitBenchmark& operator=(const BitBenchmark&) = delete;
+
+	// The input is read by READ instead of the source after the ; of the program.
+	void add(const std::string& name, const std::string& source, const std::string& input);
+	// Adds the generated programs: a long straight line program and a binary counter loop.
+	void add_generated();
+
+	void run();
+	void write_text(std::ostream& out) const;
+	void write_json(std::ostream& out) const;
+
+	// A program of the given number of lines that each assign two NANDs of variables.
+	static std::string straight_program(int line_count);
+	// A program that counts up a binary number of the given number of bits and stops on the overflow,
+	// doing a little NAND work for every step.
+	static std::string counter_program(int bit_count);
+
+private:
+	enum Backend {
+		BACKEND_TREE_WALKER,
+		BACKEND_BYTECODE,
+		BACKEND_JIT,
+		BACKEND_COUNT
+	};
+
+	struct Measurement {
+		// False if the backend isn't supported on this machine or doesn't compile the program.
+		bool measured;
+		std::string error;
+		double prepare_seconds;
+		double run_seconds;
+		uint64_t runs;
+	};
+
+	struct Workload {
+		std::string name;
+		std::string source;
+		std::string input;
+		std::string error;
+		double parse_seconds;
+		// The work of one run.
+		uint64_t lines;
+		uint64_t nands;
+		uint64_t memory_accesses;
+		uint64_t io_bits;
+		Measurement measurements[BACKEND_COUNT];
+	};
+
+	BitOptions options;
+	double min_seconds;
+	std::vector<Workload> workloads;
+
+	void count(Workload& workload) const;
+	void measure_parse(Workload& workload) const;
+	void measure(Workload& workload, Backend backend) const;
+	static const char* backend_name(Backend backend);
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+/// <summary>
+/// The bytecode a CodeNode is lowered to. Every line becomes a linear sequence of stack
+/// machine instructions followed by the jump instructions of its goto.
+/// Expression operands are pushed on a value stack, NAND and the pointer operators pop their operands.
+/// </summary>
+enum Op {
+	OP_PUSH_CONST,	// push { operand, UNDEFINED }
+	OP_PUSH_BIT,	// push { operand, BIT }, the result of a folded NAND
+	OP_LOAD_VAR,	// push the variable at address operand (-1 is the jump register)
+	OP_LOAD_IND,	// THE VALUE AT: pop an address, push the value at that address
+	OP_ADDR_OF,		// THE ADDRESS OF: pop a value, push it as address-of-a-bit
+	OP_BEYOND,		// THE VALUE BEYOND: pop an address, push the value of the next cell
+	OP_NAND,		// pop two values, push their NAND
+	OP_NOT,			// X NAND X: replace the top value
+	OP_AND,			// (A NAND B) NAND (A NAND B): pop two values, push the result
+	OP_OR,			// (A NAND A) NAND (B NAND B): pop two values, push the result
+	OP_XOR,			// the four NAND exclusive or: pop two values, push the result
+	OP_STORE,		// pop a value, store it at address operand
+	OP_STORE_IND,	// pop a value and an address, store the value at that address
+	OP_STORE_BIT,	// pop a value the type inference proved to be a bit, store it at address operand without checks
+	OP_PRINT,		// print the bit operand
+	OP_PRINT_BITS,	// print the bits of strings[operand], a fused run of PRINTs
+	OP_READ,		// read a bit into the jump register
+	OP_JMP,			// continue at instruction operand
+	OP_JZ,			// continue at instruction operand if the jump register is zero
+	OP_JO,			// continue at instruction operand if the jump register is one
+	OP_JMP_IND,		// GOTO VARIABLE: continue at the line whose number is stored at address operand
+	OP_CYCLE,		// check for an endless loop at the start of line number operand
+	OP_STEP,		// count a line against the step limit, the time limit and cancellation are checked every few thousand steps
+	OP_TRACE,		// record the start of the line with index operand in the trace
+	OP_TALLY,		// count a run of the line with index operand for the metrics
+	OP_HALT,
+	OP_COUNT
+};
+
+struct Instruction {
+	Op op;
+	int operand;
+};
+
+class BytecodeProgram {
+public:
+	std::vector<Instruction> code;
+	// Index of the first instruction of every line, in line table order.
+	std::vector<int> line_starts;
+	// Line number to first instruction, only needed by OP_JMP_IND.
+	std::unordered_map<int, int> line_pcs;
+	// The printed characters of every OP_PRINT_BITS.
+	std::vector<std::string> strings;
+	int entry;
+	int max_stack_depth;
+	// Handler addresses for direct-threaded dispatch, filled by the virtual machine on the first run.
+	mutable std::vector<const void*> handlers;
+	mutable std::once_flag handlers_filled;
+
+	BytecodeProgram() : entry(0), max_stack_depth(0) {};
+	void emit(Op op, int operand = 0) { code.push_back({ op, operand }); };
+};
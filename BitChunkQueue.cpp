@@ -0,0 +1,90 @@
+#include "BitChunkQueue.h"
+
+using namespace std;
+
+
+BitChunkQueue::BitChunkQueue(size_t chunk_size) : chunks(chunk_count), head(0), tail(0), closed(false), sleepers(0)
+{
+	for (Chunk& chunk : chunks) {
+		chunk.data.resize(chunk_size);
+		chunk.size = 0;
+	}
+}
+
+
+BitChunkQueue::Chunk* BitChunkQueue::begin_write()
+{
+	wait([this]() { return tail.load() - head.load() < chunk_count || closed.load(); });
+	if (closed.load()) {
+		return NULL;
+	}
+	return &chunks[tail.load() % chunk_count];
+}
+
+
+void BitChunkQueue::end_write()
+{
+	tail.fetch_add(1);
+	wake();
+}
+
+
+const BitChunkQueue::Chunk* BitChunkQueue::begin_read()
+{
+	wait([this]() { return head.load() != tail.load() || closed.load(); });
+	if (head.load() == tail.load()) {
+		return NULL;
+	}
+	return &chunks[head.load() % chunk_count];
+}
+
+
+void BitChunkQueue::end_read()
+{
+	head.fetch_add(1);
+	wake();
+}
+
+
+bool BitChunkQueue::is_ready() const
+{
+	return head.load() != tail.load() || closed.load();
+}
+
+
+void BitChunkQueue::wait_until_empty()
+{
+	wait([this]() { return head.load() == tail.load() || closed.load(); });
+}
+
+
+void BitChunkQueue::close()
+{
+	closed.store(true);
+	lock_guard<mutex> guard(lock);
+	changed.notify_all();
+}
+
+
+// A sleeper announces itself before it checks the condition again and the other thread changes the indexes
+// before it looks for sleepers, one of them sees the other. All accesses are sequentially consistent for that.
+template<class Condition>
+void BitChunkQueue::wait(Condition condition)
+{
+	if (condition()) {
+		return;
+	}
+	unique_lock<mutex> guard(lock);
+	sleepers.fetch_add(1);
+	changed.wait(guard, condition);
+	sleepers.fetch_sub(1);
+}
+
+
+void BitChunkQueue::wake()
+{
+	if (sleepers.load() != 0) {
+		lock_guard<mutex> guard(lock);
+		changed.notify_all();
+	}
+}
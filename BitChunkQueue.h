@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// A ring of byte chunks between one producer thread and one consumer thread, for reading input ahead of
+/// the interpreter and writing its output behind it. The chunks are allocated once. Passing a chunk is a
+/// store of an index, a thread only takes the lock to sleep when the ring is full or empty and to wake the
+/// other one up.
+/// </summary>
+class BitChunkQueue
+{
+public:
+	struct Chunk {
+		std::vector<char> data;
+		size_t size;
+	};
+
+	static const size_t chunk_count = 8;
+
+	BitChunkQueue(size_t chunk_size);
+	BitChunkQueue(const BitChunkQueue&) = delete;
+	BitChunkQueue& operator=(const BitChunkQueue&) = delete;
+
+	// The producer fills the chunk and passes it on, NULL if the queue was closed.
+	Chunk* begin_write();
+	void end_write();
+	// The consumer reads the chunk and gives it back, NULL if the queue is closed and empty.
+	const Chunk* begin_read();
+	void end_read();
+	// True if begin_read doesn't wait.
+	bool is_ready() const;
+	// The chunks written and not given back yet.
+	size_t size() const { return tail.load() - head.load(); };
+	// Waits until the consumer gave back every chunk.
+	void wait_until_empty();
+	// No chunks are passed on after the ones that are in the queue, waiting threads return.
+	void close();
+
+private:
+	std::vector<Chunk> chunks;
+	// Chunks below tail were written, chunks below head were read. Both only grow.
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+	std::atomic<bool> closed;
+	std::atomic<int> sleepers;
+	std::mutex lock;
+	std::condition_variable changed;
+
+	template<class Condition> void wait(Condition condition);
+	void wake();
+};
@@ -0,0 +1,457 @@
+#include "BitCompiled.h"
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <fstream>
+#include <filesystem>
+#include "BitNodes.h"
+
+using namespace std;
+
+const char* const BitCompiled::extension = ".bitc";
+
+// The version also has to change with the parser or the optimizer, cached files of older versions are
+// then compiled again.
+static const char magic[4] = { 'B', 'I', 'T', 'C' };
+static const int version = 3;
+
+enum ExpressionKind {
+	KIND_NAND,
+	KIND_ADDRESS_OF,
+	KIND_VALUE_BEYOND,
+	KIND_VALUE_AT,
+	KIND_CONSTANT,
+	KIND_VARIABLE,
+	KIND_FUSED
+};
+
+enum InstructionKind {
+	KIND_COMMAND,
+	KIND_ASSIGNMENT
+};
+
+// Numbers are zigzag encoded variable length integers, seven bits per byte and the lowest bits first,
+// so the small line numbers, addresses and indexes of most programs take a byte or two.
+static void put(string& data, int value) {
+	uint32_t bits = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	while (bits >= 0x80) {
+		data += (char)(bits | 0x80);
+		bits >>= 7;
+	}
+	data += (char)bits;
+}
+
+// The source size and hash of the header are unsigned 64 bit numbers in the same seven bit groups.
+static void put_wide(string& data, uint64_t value) {
+	while (value >= 0x80) {
+		data += (char)(value | 0x80);
+		value >>= 7;
+	}
+	data += (char)value;
+}
+
+// Reads the numbers of a program, every read is checked against the end of the data.
+class CompiledInput {
+public:
+	CompiledInput(const char* begin, const char* end) : current(begin), end(end), failed(false) {};
+
+	int get() {
+		uint32_t bits = 0;
+		for (int shift = 0; shift < 35; shift += 7) {
+			if (current == end) {
+				break;
+			}
+			uint8_t byte = (uint8_t)*current++;
+			bits |= (uint32_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				return (int)(bits >> 1) ^ -(int)(bits & 1);
+			}
+		}
+		failed = true;
+		current = end;
+		return 0;
+	}
+
+	uint64_t get_wide() {
+		uint64_t bits = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (current == end) {
+				break;
+			}
+			uint8_t byte = (uint8_t)*current++;
+			bits |= (uint64_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				return bits;
+			}
+		}
+		failed = true;
+		current = end;
+		return 0;
+	}
+
+	bool at_end() const { return current == end; };
+	bool ok() const { return !failed; };
+	const char* position() const { return current; };
+
+private:
+	const char* current;
+	const char* end;
+	bool failed;
+};
+
+
+// The header is the magic and the version, then the size of the source plus one and its hash, or a zero
+// if the file isn't tied to a source. Returns false if the data isn't a compiled file of this version.
+static bool read_header(const char* begin, const char* end, uint64_t& source_size, uint64_t& source_hash, const char*& programs)
+{
+	if (!BitCompiled::is_compiled(begin, end)) {
+		return false;
+	}
+	CompiledInput header(begin + sizeof(magic), end);
+	if (header.get() != version) {
+		return false;
+	}
+	source_size = header.get_wide();
+	source_hash = source_size != 0 ? header.get_wide() : 0;
+	programs = header.position();
+	return header.ok();
+}
+
+
+BitCompiled::BitCompiled() : source_size(0), source_hash(0)
+{
+}
+
+
+void BitCompiled::set_source(const char* begin, const char* end)
+{
+	source_size = (uint64_t)(end - begin) + 1;
+	source_hash = hash(begin, end);
+}
+
+
+// Children are added first, so every node only refers to nodes before it.
+int BitCompiled::add_expression(ExpressionNode* node, unordered_map<const ExpressionNode*, int>& indexes, string& expressions, int& count)
+{
+	auto found = indexes.find(node);
+	if (found != indexes.end()) {
+		return found->second;
+	}
+	if (Expression1Node* nand = dynamic_cast<Expression1Node*>(node)) {
+		int left = add_expression(nand->left, indexes, expressions, count);
+		int right = nand->right != NULL ? add_expression(nand->right, indexes, expressions, count) : -1;
+		put(expressions, KIND_NAND);
+		put(expressions, left);
+		put(expressions, right);
+	}
+	else if (Expression2Node* address_of = dynamic_cast<Expression2Node*>(node)) {
+		int child = add_expression(address_of->child, indexes, expressions, count);
+		put(expressions, KIND_ADDRESS_OF);
+		put(expressions, child);
+	}
+	else if (Expression3Node* beyond = dynamic_cast<Expression3Node*>(node)) {
+		int child = add_expression(beyond->child, indexes, expressions, count);
+		put(expressions, KIND_VALUE_BEYOND);
+		put(expressions, child);
+	}
+	else if (Expression4Node* value_at = dynamic_cast<Expression4Node*>(node)) {
+		int child = add_expression(value_at->child, indexes, expressions, count);
+		put(expressions, KIND_VALUE_AT);
+		put(expressions, child);
+	}
+	else if (Expression5Node* constant = dynamic_cast<Expression5Node*>(node)) {
+		put(expressions, KIND_CONSTANT);
+		put(expressions, constant->constant);
+		put(expressions, (int)constant->type);
+	}
+	else if (VariableNode* variable = dynamic_cast<VariableNode*>(node)) {
+		put(expressions, KIND_VARIABLE);
+		put(expressions, variable->address);
+	}
+	else {
+		FusedNode* fused = static_cast<FusedNode*>(node);
+		int left = add_expression(fused->left, indexes, expressions, count);
+		int right = fused->right != NULL ? add_expression(fused->right, indexes, expressions, count) : -1;
+		put(expressions, KIND_FUSED);
+		put(expressions, (int)fused->op);
+		put(expressions, left);
+		put(expressions, right);
+	}
+	indexes[node] = count;
+	return count++;
+}
+
+
+void BitCompiled::add(const CodeNode& code)
+{
+	unordered_map<const ExpressionNode*, int> indexes;
+	string expressions;
+	string lines;
+	int expression_count = 0;
+	// The lines are in line number order, only the distance to the line before is stored.
+	int previous_line_number = -1;
+	for (const LineNode* line : code.table) {
+		put(lines, line->line_number - previous_line_number);
+		previous_line_number = line->line_number;
+		if (CommandNode* command = dynamic_cast<CommandNode*>(line->instruction)) {
+			put(lines, KIND_COMMAND);
+			put(lines, command->print_value);
+		}
+		else {
+			AssignmentNode* assignment = static_cast<AssignmentNode*>(line->instruction);
+			int address_expression = assignment->address_expression != NULL ? add_expression(assignment->address_expression, indexes, expressions, expression_count) : -1;
+			int expression = add_expression(assignment->expression, indexes, expressions, expression_count);
+			put(lines, KIND_ASSIGNMENT);
+			put(lines, assignment->address);
+			put(lines, address_expression);
+			put(lines, expression);
+		}
+		const GotoNode* go = line->go;
+		put(lines, go != NULL ? 1 : 0);
+		if (go != NULL) {
+			put(lines, go->next);
+			put(lines, go->variable ? 1 : 0);
+			put(lines, go->next_if_zero);
+			put(lines, go->next_if_one);
+		}
+	}
+	string counts;
+	put(counts, (int)code.table.size());
+	put(counts, expression_count);
+	put(counts, code.first_line_number);
+	put(data, (int)(counts.size() + expressions.size() + lines.size()));
+	data += counts;
+	data += expressions;
+	data += lines;
+}
+
+
+bool BitCompiled::save(const string& path) const
+{
+	string temporary = path + ".tmp";
+	{
+		string header(magic, sizeof(magic));
+		put(header, version);
+		put_wide(header, source_size);
+		if (source_size != 0) {
+			put_wide(header, source_hash);
+		}
+		ofstream file(temporary, ios::binary | ios::trunc);
+		if (!file.write(header.data(), header.size()) || !file.write(data.data(), data.size())) {
+			return false;
+		}
+	}
+	error_code error;
+	filesystem::rename(temporary, path, error);
+	if (error) {
+		remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+bool BitCompiled::is_compiled(const char* begin, const char* end)
+{
+	return (size_t)(end - begin) >= sizeof(magic) && memcmp(begin, magic, sizeof(magic)) == 0;
+}
+
+
+// Creates the nodes of one program, returns NULL if the data is damaged.
+static CodeNode* load_program(CompiledInput& input)
+{
+	unique_ptr<CodeNode> code(new CodeNode());
+	BitArena& arena = code->arena;
+	int line_count = input.get();
+	int expression_count = input.get();
+	code->first_line_number = input.get();
+	vector<ExpressionNode*> expressions;
+	// A child is an earlier node, optional children are -1.
+	auto child = [&](int index, bool optional) -> ExpressionNode* {
+		if (optional && index == -1) {
+			return NULL;
+		}
+		return index >= 0 && (size_t)index < expressions.size() ? expressions[index] : NULL;
+	};
+	for (int i = 0; i < expression_count && input.ok(); i++) {
+		ExpressionNode* node = NULL;
+		switch (input.get()) {
+		case KIND_NAND:
+			{
+				Expression1Node* nand = arena.create<Expression1Node>();
+				nand->left = child(input.get(), false);
+				int right = input.get();
+				nand->right = child(right, true);
+				node = nand->left != NULL && (right == -1 || nand->right != NULL) ? nand : NULL;
+			}
+			break;
+		case KIND_ADDRESS_OF:
+			{
+				Expression2Node* address_of = arena.create<Expression2Node>();
+				address_of->child = child(input.get(), false);
+				node = address_of->child != NULL ? address_of : NULL;
+			}
+			break;
+		case KIND_VALUE_BEYOND:
+			{
+				Expression3Node* beyond = arena.create<Expression3Node>();
+				beyond->child = child(input.get(), false);
+				node = beyond->child != NULL ? beyond : NULL;
+			}
+			break;
+		case KIND_VALUE_AT:
+			{
+				Expression4Node* value_at = arena.create<Expression4Node>();
+				value_at->child = child(input.get(), false);
+				node = value_at->child != NULL ? value_at : NULL;
+			}
+			break;
+		case KIND_CONSTANT:
+			{
+				Expression5Node* constant = arena.create<Expression5Node>();
+				constant->constant = input.get();
+				int type = input.get();
+				constant->type = (ValueType)type;
+				bool fits = constant->constant >= 0 && constant->constant <= Value::max_payload;
+				node = fits && type >= UNDEFINED && type <= ADDRESS_OF_A_BIT ? constant : NULL;
+			}
+			break;
+		case KIND_VARIABLE:
+			{
+				VariableNode* variable = arena.create<VariableNode>();
+				variable->address = input.get();
+				bool fits = variable->address >= jump_register_address && variable->address <= Value::max_payload;
+				node = fits ? variable : NULL;
+			}
+			break;
+		case KIND_FUSED:
+			{
+				FusedNode* fused = arena.create<FusedNode>();
+				int op = input.get();
+				fused->op = (Op)op;
+				fused->left = child(input.get(), false);
+				int right = input.get();
+				fused->right = child(right, true);
+				bool unary = op == OP_NOT;
+				bool known = unary || op == OP_AND || op == OP_OR || op == OP_XOR;
+				node = known && fused->left != NULL && (unary ? right == -1 : fused->right != NULL) ? fused : NULL;
+			}
+			break;
+		default:
+			break;
+		}
+		if (node == NULL) {
+			return NULL;
+		}
+		expressions.push_back(node);
+	}
+	int line_number = -1;
+	for (int i = 0; i < line_count && input.ok(); i++) {
+		int distance = input.get();
+		if (distance <= 0 || line_number > INT_MAX - distance) {
+			return NULL;
+		}
+		line_number += distance;
+		auto entry = code->lines.try_emplace(line_number);
+		LineNode* line = &entry.first->second;
+		line->line_number = line_number;
+		int kind = input.get();
+		if (kind == KIND_COMMAND) {
+			CommandNode* command = arena.create<CommandNode>();
+			command->print_value = input.get();
+			if (command->print_value < -1 || command->print_value > 1) {
+				return NULL;
+			}
+			line->instruction = command;
+		}
+		else if (kind == KIND_ASSIGNMENT) {
+			AssignmentNode* assignment = arena.create<AssignmentNode>();
+			assignment->address = input.get();
+			int address_expression = input.get();
+			assignment->address_expression = child(address_expression, true);
+			assignment->expression = child(input.get(), false);
+			bool indirect = assignment->address < jump_register_address;
+			if (assignment->expression == NULL || indirect != (assignment->address_expression != NULL) || assignment->address > Value::max_payload) {
+				return NULL;
+			}
+			line->instruction = assignment;
+		}
+		else {
+			return NULL;
+		}
+		if (input.get() != 0) {
+			GotoNode* go = arena.create<GotoNode>();
+			go->next = input.get();
+			int variable = input.get();
+			go->variable = variable == 1;
+			go->next_if_zero = input.get();
+			go->next_if_one = input.get();
+			if (variable != 0 && variable != 1) {
+				return NULL;
+			}
+			line->go = go;
+		}
+	}
+	int missing_line_number;
+	if (!input.ok() || !input.at_end() || code->link(missing_line_number) != NULL || code->first_line == NULL) {
+		return NULL;
+	}
+	return code.release();
+}
+
+
+bool BitCompiled::load(const char* begin, const char* end, vector<unique_ptr<CodeNode>>& programs)
+{
+	programs.clear();
+	uint64_t source_size;
+	uint64_t source_hash;
+	const char* current;
+	if (!read_header(begin, end, source_size, source_hash, current)) {
+		return false;
+	}
+	while (current != end) {
+		CompiledInput size(current, end);
+		int program_size = size.get();
+		current = size.position();
+		if (!size.ok() || program_size < 0 || (size_t)program_size > (size_t)(end - current)) {
+			return false;
+		}
+		CompiledInput input(current, current + program_size);
+		CodeNode* code = load_program(input);
+		if (code == NULL) {
+			return false;
+		}
+		programs.emplace_back(code);
+		current += program_size;
+	}
+	return !programs.empty();
+}
+
+
+bool BitCompiled::is_compiled_from(const char* begin, const char* end, const char* source_begin, const char* source_end)
+{
+	uint64_t source_size;
+	uint64_t source_hash;
+	const char* programs;
+	return read_header(begin, end, source_size, source_hash, programs)
+		&& source_size == (uint64_t)(source_end - source_begin) + 1 && source_hash == hash(source_begin, source_end);
+}
+
+
+// 64 bit FNV-1a.
+uint64_t BitCompiled::hash(const char* begin, const char* end)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char* character = begin; character != end; character++) {
+		hash = (hash ^ (uint8_t)*character) * 1099511628211ull;
+	}
+	return hash;
+}
+
+
+string BitCompiled::cache_name(const char* begin, const char* end, bool optimize)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx%s", (unsigned long long)hash(begin, end), optimize ? "" : "-u");
+	return name + string(extension);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+class CodeNode;
+class ExpressionNode;
+
+/// <summary>
+/// The binary form of parsed, linked and optimized programs, the .bitc files. A file holds the programs
+/// of a source in order. Every program is its expressions and its lines: the expressions are a table in
+/// which nodes refer to their children by index, so subexpressions shared by the optimizer stay shared,
+/// and the lines hold their instruction and goto with expression indexes.
+/// Loading creates the nodes directly and links the lines again, nothing is lexed or parsed.
+/// Numbers are stored with variable length, independent of the byte order. Files of other versions are rejected.
+/// Files in a cache also hold the size and the hash of their source, so a file is never used for another source.
+/// </summary>
+class BitCompiled
+{
+public:
+	static const char* const extension;
+
+	BitCompiled();
+	BitCompiled(const BitCompiled&) = delete;
+	BitCompiled& operator=(const BitCompiled&) = delete;
+
+	// Ties the file to the source its programs are compiled from, with the size and the hash of the source.
+	void set_source(const char* begin, const char* end);
+	void add(const CodeNode& code);
+	// Writes a temporary file first and renames it, readers never see a partial file.
+	bool save(const std::string& path) const;
+
+	static bool is_compiled(const char* begin, const char* end);
+	// Creates the programs of the data, returns false if it is damaged or of another version.
+	static bool load(const char* begin, const char* end, std::vector<std::unique_ptr<CodeNode>>& programs);
+	// Whether the data is a compiled file of this version tied to the source, cached files are only
+	// used for the source they were compiled from.
+	static bool is_compiled_from(const char* begin, const char* end, const char* source_begin, const char* source_end);
+	// A 64 bit hash of a source, for finding its compiled programs.
+	static uint64_t hash(const char* begin, const char* end);
+	// The name of a source in a cache directory, from a hash of its content and the optimize option.
+	static std::string cache_name(const char* begin, const char* end, bool optimize);
+
+private:
+	// The programs, the header is written when the file is saved.
+	std::string data;
+	// The size of the source plus one, zero if the file isn't tied to a source.
+	uint64_t source_size;
+	uint64_t source_hash;
+
+	int add_expression(ExpressionNode* node, std::unordered_map<const ExpressionNode*, int>& indexes, std::string& expressions, int& count);
+};
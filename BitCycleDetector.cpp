@@ -0,0 +1,57 @@
+#include "BitCycleDetector.h"
+#include <algorithm>
+
+
+BitCycleDetector::BitCycleDetector()
+{
+	clear();
+}
+
+
+void BitCycleDetector::restart()
+{
+	has_snapshot = false;
+	visits = 0;
+	next_snapshot = 1;
+	snapshot_step = 0;
+	loop_lines = 0;
+	output.clear();
+	printing_lines.clear();
+}
+
+
+void BitCycleDetector::clear()
+{
+	memory_hash = 0;
+	snapshot.clear();
+	restart();
+}
+
+
+bool BitCycleDetector::visit(int line, int jump_register, const BitMemory& memory, uint64_t step)
+{
+	if (has_snapshot && line == snapshot_line && jump_register == snapshot_jump_register
+		&& memory_hash == snapshot_hash && memory.equals(snapshot)) {
+		loop_lines = step - snapshot_step;
+		return true;
+	}
+	if (++visits == next_snapshot) {
+		snapshot.copy_from(memory);
+		snapshot_hash = memory_hash;
+		snapshot_line = line;
+		snapshot_jump_register = jump_register;
+		snapshot_step = step;
+		has_snapshot = true;
+		visits = 0;
+		next_snapshot *= 2;
+		output.clear();
+		printing_lines.clear();
+	}
+	return false;
+}
+
+
+size_t BitCycleDetector::printed_by(uint64_t lines) const
+{
+	return std::upper_bound(printing_lines.begin(), printing_lines.end(), lines) - printing_lines.begin();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "BitValue.h"
+#include "BitMemory.h"
+
+/// <summary>
+/// Recognizes a program state that repeats, which means a program without input loops forever.
+/// The state is the current line, the jump register and the memory. Memory is tracked through a
+/// hash that every write updates, a full comparison is only made when the hashes are equal.
+/// States are compared against a snapshot that is taken again after 1, 2, 4, ... visits (Brent's
+/// algorithm), so a loop is found after at most a few times its length. Reading input starts over.
+/// The snapshot shares the memory pages, only pages written since then are compared.
+/// The lines run are passed in as steps, they measure a loop in lines. They are only counted in runs with limits.
+/// </summary>
+class BitCycleDetector
+{
+public:
+	// A loop that prints more than this many bits per iteration is not recognized.
+	static const size_t max_period = 1 << 20;
+
+	BitCycleDetector();
+	BitCycleDetector(const BitCycleDetector&) = delete;
+	BitCycleDetector& operator=(const BitCycleDetector&) = delete;
+
+	inline void write(int address, Value old_value, Value new_value) {
+		memory_hash ^= hash(address, old_value) ^ hash(address, new_value);
+	}
+
+	inline void print(char bit, uint64_t step) {
+		output.push_back(bit);
+		printing_lines.push_back(step - snapshot_step);
+		if (output.size() > max_period) {
+			restart();
+		}
+	}
+
+	// Forgets the snapshot, the state before input can't repeat the state after it.
+	void restart();
+	// Starts with a new program and cleared memory.
+	void clear();
+	// True if the state at line equals the snapshot.
+	bool visit(int line, int jump_register, const BitMemory& memory, uint64_t step);
+	// The bits printed since the snapshot, which are printed again on every iteration of the loop.
+	const std::string& period() const { return output; };
+	// The lines of one iteration of the loop.
+	uint64_t period_lines() const { return loop_lines; };
+	// The bits of the period the first lines of an iteration print.
+	size_t printed_by(uint64_t lines) const;
+
+private:
+	uint64_t memory_hash;
+	BitMemory snapshot;
+	uint64_t snapshot_hash;
+	int snapshot_line;
+	int snapshot_jump_register;
+	bool has_snapshot;
+	uint64_t snapshot_step;
+	uint64_t loop_lines;
+	uint64_t visits;
+	uint64_t next_snapshot;
+	std::string output;
+	// The line of the iteration that printed each bit of the output, the line of the snapshot is one.
+	std::vector<uint64_t> printing_lines;
+
+	// Undefined zeros hash to zero, so a cell that was never written is the same as a cleared cell.
+	static inline uint64_t hash(int address, Value value) {
+		if (value.word == 0) {
+			return 0;
+		}
+		uint64_t x = (uint64_t)(uint32_t)address << 32 | value.word;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+};
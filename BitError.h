@@ -0,0 +1,45 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+/// <summary>
+/// A runtime error of a BIT program. The program can't continue, the next run starts with a fresh state.
+/// </summary>
+class BitError : public std::runtime_error
+{
+public:
+	BitError(const std::string& message) : std::runtime_error(message) {};
+};
+
+enum BitLimit {
+	LIMIT_STEPS,
+	LIMIT_TIME,
+	LIMIT_CANCELLED
+};
+
+/// <summary>
+/// A run that was stopped by a limit of the options or by cancellation. The program itself has no error,
+/// it may just need longer.
+/// </summary>
+class BitLimitError : public BitError
+{
+public:
+	BitLimit limit;
+
+	BitLimitError(const std::string& message, BitLimit limit) : BitError(message), limit(limit) {};
+};
+
+/// <summary>
+/// A syntax error in the source, with the source around its position.
+/// </summary>
+class BitParserError : public BitError
+{
+public:
+	int position;
+	std::string excerpt;
+	// Offset of the position in the excerpt.
+	int excerpt_position;
+
+	BitParserError(const std::string& message, int position, const std::string& excerpt, int excerpt_position)
+		: BitError(message), position(position), excerpt(excerpt), excerpt_position(excerpt_position) {};
+};
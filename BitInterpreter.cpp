@@ -0,0 +1,722 @@
+#include "BitInterpreter.h"
+#include <string>
+#include <vector>
+#include <ctype.h>
+#include <thread>
+#include "BitNodes.h"
+#include "BitProgram.h"
+#include "BitSpeculation.h"
+
+using namespace std;
+
+BitInterpreter::BitInterpreter(BitReader& input, BitWriter& output, const BitOptions& options) : options(options), profile(NULL), trace(NULL), input(&input), output(&output), running(NULL), stop_pc(0), speculative(false) {
+	reset();
+}
+
+void BitInterpreter::reset() {
+	memory.clear();
+	cycle_detector.clear();
+	cycle_mode = options.cycle_mode;
+	registers.jump_register = 0;
+	registers.stopped = 0;
+	output_byte = 0;
+	output_bit_count = 0;
+	input_bit_count = 0;
+	native_error = NULL;
+	steps = 0;
+	if (trace != NULL) {
+		trace->clear();
+	}
+	if (options.time_limit > 0) {
+		deadline = chrono::steady_clock::now() + chrono::milliseconds(options.time_limit);
+	}
+	start_countdown();
+}
+
+void BitInterpreter::run(const BitProgram& program) {
+	reset();
+	execute(program);
+}
+
+void BitInterpreter::run(const BitProgram& program, const BitSnapshot& start) {
+	reset();
+	memory.copy_from(start.memory);
+	registers.jump_register = start.jump_register;
+	execute(program);
+}
+
+void BitInterpreter::save(BitSnapshot& snapshot) const {
+	snapshot.memory.copy_from(memory);
+	snapshot.jump_register = registers.jump_register;
+}
+
+// A countdown that ran out was added to the steps already.
+uint64_t BitInterpreter::step_count() const {
+	return steps + (registers.countdown > 0 ? step_batch - registers.countdown : 0);
+}
+
+void BitInterpreter::execute(const BitProgram& program, int pc) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	running = &program;
+	registers.tallies = NULL;
+	if (!program.work.empty()) {
+		tallies.assign(program.work.size(), 0);
+		registers.tallies = tallies.data();
+	}
+	try {
+		if (program.jit != NULL) {
+			run_native(*program.jit, program.bytecode);
+		}
+		else if (!program.bytecode.code.empty()) {
+			run_bytecode(program.bytecode, pc < 0 ? program.bytecode.entry : pc);
+		}
+		else {
+			program.code->run(*this);
+		}
+	}
+	catch (...) {
+		count_run(program, start, true);
+		throw;
+	}
+	count_run(program, start, false);
+}
+
+// Without tallies the lines are only known from the countdown of runs with limits. Memory isn't released
+// during a run, so its size at the end is the peak of the run.
+void BitInterpreter::count_run(const BitProgram& program, chrono::steady_clock::time_point start, bool failed) {
+	metrics.runs++;
+	metrics.failed_runs += failed ? 1 : 0;
+	if (registers.tallies != NULL) {
+		for (size_t index = 0; index < tallies.size(); index++) {
+			const BitMetrics::Work& work = program.work[index];
+			metrics.lines += tallies[index];
+			metrics.nands += tallies[index] * work.nands;
+			metrics.memory_reads += tallies[index] * work.memory_reads;
+			metrics.memory_writes += tallies[index] * work.memory_writes;
+		}
+		registers.tallies = NULL;
+	}
+	else if (options.has_limits()) {
+		metrics.lines += step_count();
+	}
+	uint64_t cells = (uint64_t)memory.page_count() * BitMemory::page_size;
+	if (cells > metrics.peak_memory_cells) {
+		metrics.peak_memory_cells = cells;
+	}
+	metrics.run_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void BitInterpreter::fail(const string& message) {
+	throw BitError(message);
+}
+
+#pragma region Interpreter
+
+void BitInterpreter::print_bit(int value) {
+	metrics.bits_printed++;
+	if (cycle_mode != CYCLES_IGNORED) {
+		cycle_detector.print((char)('0' + value), step_count());
+	}
+	if (options.print_ascii) {
+		output_byte = (uint8_t)((output_byte << 1) | value);
+		if (++output_bit_count == 8) {
+			output->put((char)output_byte);
+			output_byte = 0;
+			output_bit_count = 0;
+		}
+	}
+	else {
+		output->put((char)('0' + value));
+	}
+}
+
+void BitInterpreter::print_bits(const char* bits, int count) {
+	if (cycle_mode != CYCLES_IGNORED) {
+		uint64_t step = step_count();
+		for (int i = 0; i < count; i++) {
+			cycle_detector.print(bits[i], step);
+		}
+	}
+	if (options.print_ascii) {
+		for (int i = 0; i < count; i++) {
+			print_bit(bits[i] - '0');
+		}
+	}
+	else {
+		metrics.bits_printed += count;
+		output->write(bits, count);
+	}
+}
+
+int BitInterpreter::read_bit() {
+	if (cycle_mode != CYCLES_IGNORED) {
+		cycle_detector.restart();
+	}
+	if (options.read_ascii) {
+		if (input_bit_count == 0) {
+			if (!input->is_buffered()) {
+				output->push();
+			}
+			int character = input->peek();
+			if (character == EOF) {
+				fail("No input left to read.");
+			}
+			input->advance();
+			input_byte = (uint8_t)character;
+			input_bit_count = 8;
+		}
+		input_bit_count--;
+		metrics.bits_read++;
+		return (input_byte >> input_bit_count) & 1;
+	}
+	int character;
+	for (;;) {
+		// Show everything printed so far before waiting for more input.
+		if (!input->is_buffered()) {
+			output->push();
+		}
+		character = input->peek();
+		if (character == EOF || !isspace(character)) {
+			break;
+		}
+		input->advance();
+	}
+	if (character != '0' && character != '1') {
+		fail("Invalid value read.");
+	}
+	input->advance();
+	metrics.bits_read++;
+	return character - '0';
+}
+
+Value BitInterpreter::memory_read(int address) {
+	if (profile != NULL) {
+		profile->read(address);
+	}
+	if (address == jump_register_address) {
+		return Value::make(registers.jump_register, BIT);
+	}
+	else {
+		if (address > jump_register_address) {
+			return memory.read(address);
+		}
+		else {
+			fail("Invalid memory address: " + to_string(address) + ".");
+		}
+	}
+}
+
+void BitInterpreter::memory_write(int address, Value value) {
+	if (profile != NULL) {
+		profile->write(address);
+	}
+#ifdef BIT_TRACING
+	if (trace != NULL) {
+		trace->write(address, value);
+	}
+#endif
+	if (value.type() == BIT && !value.is_bit()) {
+		fail("Illegal value: " + to_string(value.payload()));
+	}
+	if (address == jump_register_address) {
+		if (value.type() == ADDRESS_OF_A_BIT) {
+			fail("The jump register can't store address-of-a-bit values.");
+		}
+		registers.jump_register = value.payload();
+	}
+	else {
+		if (address > jump_register_address) {
+			if (cycle_mode != CYCLES_IGNORED) {
+				cycle_detector.write(address, memory.read(address), value);
+			}
+			memory.write(address, value);
+		}
+		else {
+			fail("Invalid memory address: " + to_string(address) + ".");
+		}
+	}
+}
+
+void BitInterpreter::check_cycle(int line_number) {
+	if (cycle_mode == CYCLES_IGNORED || !cycle_detector.visit(line_number, registers.jump_register, memory, step_count())) {
+		return;
+	}
+	if (cycle_mode == CYCLES_FAST_FORWARDED && options.max_steps != 0) {
+		cycle_mode = CYCLES_IGNORED;
+		fast_forward_to_step_limit();
+	}
+	if (!cycle_detector.period().empty()) {
+		// Every further iteration prints the same bits and the program never ends.
+		// They are repeated into one large block, so short loops don't print a few bits at a time.
+		string period = cycle_detector.period();
+		while (period.size() < BitWriter::buffer_size) {
+			period += cycle_detector.period();
+		}
+		CycleMode mode = cycle_mode;
+		cycle_mode = CYCLES_IGNORED;
+		while (mode == CYCLES_FAST_FORWARDED) {
+			print_bits(period.data(), (int)period.size());
+			check_time();
+		}
+		return;
+	}
+	fail("Endless loop at line " + to_string(line_number) + ", the program is in the same state as before.");
+}
+
+// The loop runs until the step limit stops it, so it prints what it would print without the detection: the
+// whole iterations that fit into the remaining lines, then the bits of the lines of the one the limit cuts off.
+void BitInterpreter::fast_forward_to_step_limit() {
+	const string& period = cycle_detector.period();
+	uint64_t remaining = options.max_steps - step_count();
+	uint64_t iterations = remaining / cycle_detector.period_lines();
+	if (!period.empty()) {
+		string block = period;
+		uint64_t block_iterations = 1;
+		while (block.size() < BitWriter::buffer_size) {
+			block += period;
+			block_iterations++;
+		}
+		for (; iterations >= block_iterations; iterations -= block_iterations) {
+			print_bits(block.data(), (int)block.size());
+			check_time();
+		}
+		for (; iterations > 0; iterations--) {
+			print_bits(period.data(), (int)period.size());
+		}
+		print_bits(period.data(), (int)cycle_detector.printed_by(remaining % cycle_detector.period_lines()));
+	}
+	// The countdown ran out on the line after the last allowed one.
+	steps = options.max_steps + 1;
+	registers.countdown = 0;
+	throw BitLimitError("The step limit of " + to_string(options.max_steps) + " lines was reached.", LIMIT_STEPS);
+}
+
+// Checking less often keeps the clock out of the loop, the step limit still ends the countdown on the exact line.
+static const int step_check_interval = 1 << 12;
+
+void BitInterpreter::start_countdown() {
+	step_batch = step_check_interval;
+	if (options.max_steps != 0 && options.max_steps - steps < (uint64_t)step_batch) {
+		// The line after the last allowed one ends the countdown.
+		step_batch = (int)(options.max_steps - steps) + 1;
+	}
+	registers.countdown = step_batch;
+}
+
+void BitInterpreter::check_limits() {
+	steps += step_batch;
+	if (options.max_steps != 0 && steps > options.max_steps) {
+		throw BitLimitError("The step limit of " + to_string(options.max_steps) + " lines was reached.", LIMIT_STEPS);
+	}
+	check_time();
+	start_countdown();
+}
+
+void BitInterpreter::check_time() {
+	if (options.cancel != NULL && options.cancel->load(memory_order_relaxed)) {
+		throw BitLimitError("The program was cancelled.", LIMIT_CANCELLED);
+	}
+	if (options.time_limit > 0 && chrono::steady_clock::now() >= deadline) {
+		throw BitLimitError("The time limit of " + to_string(options.time_limit) + " ms was reached.", LIMIT_TIME);
+	}
+}
+
+// The result is a bit again, the payload bit of both words is the lowest bit above the type.
+Value BitInterpreter::nand(Value left, Value right) {
+	if (!left.is_bit() || !right.is_bit()) {
+		fail("The NAND operator requires bit values.");
+	}
+	return{ ((left.word & right.word & (1 << Value::type_bits)) ^ (1 << Value::type_bits)) | BIT };
+}
+
+// The fused operations are defined by their NAND forms, including the checks of every NAND.
+
+Value BitInterpreter::fused_not(Value value) {
+	return nand(value, value);
+}
+
+Value BitInterpreter::fused_and(Value left, Value right) {
+	Value both = nand(left, right);
+	return nand(both, both);
+}
+
+Value BitInterpreter::fused_or(Value left, Value right) {
+	Value not_left = nand(left, left);
+	Value not_right = nand(right, right);
+	return nand(not_left, not_right);
+}
+
+Value BitInterpreter::fused_xor(Value left, Value right) {
+	Value both = nand(left, right);
+	Value only_left = nand(left, both);
+	Value only_right = nand(right, both);
+	return nand(only_left, only_right);
+}
+
+Value BitInterpreter::address_of(Value value) {
+	if (value.type() == ADDRESS_OF_A_BIT) {
+		fail("The THE ADDRESS OF operator requires a bit value.");
+	}
+	int address = value.payload();
+	if (address < jump_register_address) {
+		fail("Invalid memory address: " + to_string(address) + ".");
+	}
+	if (address == jump_register_address) {
+		fail("The THE ADDRESS OF operator can't be used with the jump register.");
+	}
+	return Value::make(address, ADDRESS_OF_A_BIT);
+}
+
+Value BitInterpreter::value_beyond(Value value) {
+	if (value.type() == BIT) {
+		fail("The THE VALUE BEYOND operator requires an address-of-a-bit value.");
+	}
+	int address = value.payload();
+	if (address < 0) {
+		fail("Invalid memory address: " + to_string(address) + ".");
+	}
+	Value result = memory_read(address + 1);
+	if (result.type() == ADDRESS_OF_A_BIT) {
+		fail("Variable must contain a bit value.");
+	}
+	return result;
+}
+
+Value BitInterpreter::value_at(Value value) {
+	if (value.type() == BIT) {
+		fail("The THE VALUE AT operator requires an address-of-a-bit value.");
+	}
+	int address = value.payload();
+	if (address < 0) {
+		fail("Invalid memory address: " + to_string(address) + ".");
+	}
+	Value result = memory_read(address);
+	if (result.type() == ADDRESS_OF_A_BIT) {
+		fail("Variable must contain a bit value.");
+	}
+	return result;
+}
+
+#pragma endregion
+
+#pragma region Virtual machine
+
+// GCC and Clang support labels as values, which allows direct-threaded dispatch.
+// Other compilers use a switch in a loop.
+// The handlers of a program are the label addresses of one copy of the function, so it must not be inlined
+// or cloned. The table of the labels is a local for the same reason, link time optimization puts a static
+// table into another partition than the labels.
+#if defined(__GNUC__)
+#define BIT_THREADED_DISPATCH
+#if defined(__clang__)
+#define BIT_DISPATCH_FUNCTION __attribute__((noinline))
+#else
+#define BIT_DISPATCH_FUNCTION __attribute__((noinline, noclone))
+#endif
+#else
+#define BIT_DISPATCH_FUNCTION
+#endif
+
+BIT_DISPATCH_FUNCTION void BitInterpreter::run_bytecode(const BytecodeProgram& program, int pc) {
+	vector<Value> stack(program.max_stack_depth + 1);
+	Value* sp = stack.data();
+	const Instruction* code = program.code.data();
+	uint64_t* const tallies = registers.tallies;
+#ifdef BIT_TRACING
+	BitTrace* const tracer = trace;
+#endif
+
+#ifdef BIT_THREADED_DISPATCH
+	const void* const labels[OP_COUNT] = {
+		&&op_OP_PUSH_CONST, &&op_OP_PUSH_BIT, &&op_OP_LOAD_VAR, &&op_OP_LOAD_IND, &&op_OP_ADDR_OF, &&op_OP_BEYOND,
+		&&op_OP_NAND, &&op_OP_NOT, &&op_OP_AND, &&op_OP_OR, &&op_OP_XOR, &&op_OP_STORE, &&op_OP_STORE_IND, &&op_OP_STORE_BIT, &&op_OP_PRINT, &&op_OP_PRINT_BITS, &&op_OP_READ,
+		&&op_OP_JMP, &&op_OP_JZ, &&op_OP_JO, &&op_OP_JMP_IND, &&op_OP_CYCLE, &&op_OP_STEP, &&op_OP_TRACE, &&op_OP_TALLY, &&op_OP_HALT
+	};
+	// Interpreters on other threads may run the same program.
+	call_once(program.handlers_filled, [&]() {
+		for (const Instruction& instruction : program.code) {
+			program.handlers.push_back(labels[instruction.op]);
+		}
+	});
+	const void* const* handlers = program.handlers.data();
+#define VM_CASE(op) op_##op:
+#define VM_NEXT() goto *handlers[pc]
+	VM_NEXT();
+#else
+#define VM_CASE(op) case op:
+#define VM_NEXT() continue
+	for (;;) switch (code[pc].op) {
+#endif
+
+	VM_CASE(OP_PUSH_CONST)
+		*sp++ = Value::make(code[pc].operand, UNDEFINED);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_PUSH_BIT)
+		*sp++ = Value::make(code[pc].operand, BIT);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_LOAD_VAR)
+		*sp++ = load_variable(code[pc].operand);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_LOAD_IND)
+		sp[-1] = value_at(sp[-1]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_ADDR_OF)
+		sp[-1] = address_of(sp[-1]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_BEYOND)
+		sp[-1] = value_beyond(sp[-1]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_NAND)
+		sp--;
+		sp[-1] = nand(sp[-1], sp[0]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_NOT)
+		sp[-1] = fused_not(sp[-1]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_AND)
+		sp--;
+		sp[-1] = fused_and(sp[-1], sp[0]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_OR)
+		sp--;
+		sp[-1] = fused_or(sp[-1], sp[0]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_XOR)
+		sp--;
+		sp[-1] = fused_xor(sp[-1], sp[0]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_STORE)
+		memory_write(code[pc].operand, *--sp);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_STORE_IND)
+		sp -= 2;
+		memory_write(sp[0].payload(), sp[1]);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_STORE_BIT)
+		store_bit(code[pc].operand, *--sp);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_PRINT)
+		print_bit(code[pc].operand);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_PRINT_BITS)
+		{
+			const string& bits = program.strings[code[pc].operand];
+			print_bits(bits.data(), (int)bits.size());
+		}
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_READ)
+		if (options.speculate) {
+			if (speculative) {
+				stop_pc = pc;
+				return;
+			}
+			pc = read_speculatively(pc);
+			VM_NEXT();
+		}
+		memory_write(jump_register_address, Value::make(read_bit(), BIT));
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_JMP)
+		pc = code[pc].operand;
+		VM_NEXT();
+	VM_CASE(OP_JZ)
+		pc = (registers.jump_register == 0) ? code[pc].operand : pc + 1;
+		VM_NEXT();
+	VM_CASE(OP_JO)
+		pc = (registers.jump_register == 1) ? code[pc].operand : pc + 1;
+		VM_NEXT();
+	VM_CASE(OP_JMP_IND)
+		{
+			int next_line_number = memory_read(code[pc].operand).payload();
+			auto it = program.line_pcs.find(next_line_number);
+			if (it == program.line_pcs.end()) {
+				fail("No line exists with number " + to_string(next_line_number) + ".");
+			}
+			pc = it->second;
+		}
+		VM_NEXT();
+	VM_CASE(OP_CYCLE)
+		check_cycle(code[pc].operand);
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_STEP)
+		step();
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_TRACE)
+#ifdef BIT_TRACING
+		if (tracer != NULL) {
+			tracer->line(code[pc].operand, registers.jump_register);
+		}
+#endif
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_TALLY)
+		tallies[code[pc].operand]++;
+		pc++;
+		VM_NEXT();
+	VM_CASE(OP_HALT)
+		stop_pc = pc;
+		return;
+
+#ifndef BIT_THREADED_DISPATCH
+	default:
+		return;
+	}
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+// The branches start with a copy of the state after the line of the READ was counted. A branch that reaches
+// the step limit, the time limit or an error is discarded, the interpreter runs its lines again and stops there itself.
+// Branches need cores of their own, on a single core they would only take turns with the threads of the streams.
+int BitInterpreter::read_speculatively(int pc) {
+	static const bool has_cores = thread::hardware_concurrency() > 1;
+	bool waits = has_cores && !input->is_buffered() && (!options.read_ascii || input_bit_count == 0);
+	uint64_t remaining = options.max_steps != 0 ? options.max_steps - step_count() : BitSpeculation::max_lines;
+	if (!waits || remaining == 0 || cycle_mode != CYCLES_IGNORED || trace != NULL) {
+		memory_write(jump_register_address, Value::make(read_bit(), BIT));
+		return pc + 1;
+	}
+	output->push();
+	BitOptions branch_options = options;
+	branch_options.max_steps = remaining < BitSpeculation::max_lines ? remaining : BitSpeculation::max_lines;
+	unique_ptr<BitSpeculation> branches[2];
+	for (int bit = 0; bit < 2; bit++) {
+		branches[bit].reset(new BitSpeculation(branch_options));
+		BitInterpreter& branch = branches[bit]->branch();
+		branch.memory.copy_from(memory);
+		branch.registers.jump_register = bit;
+		branch.output_byte = output_byte;
+		branch.output_bit_count = output_bit_count;
+		branch.deadline = deadline;
+		branches[bit]->start(*running, pc + 1);
+	}
+	int bit = read_bit();
+	branches[1 - bit]->cancel();
+	if (!branches[bit]->finish()) {
+		memory_write(jump_register_address, Value::make(bit, BIT));
+		return pc + 1;
+	}
+	commit(*branches[bit]);
+	return branches[bit]->branch().stop_pc;
+}
+
+// The lines of the branch count as lines of this run, without tallies they are in its steps.
+void BitInterpreter::commit(BitSpeculation& speculation) {
+	BitInterpreter& branch = speculation.branch();
+	memory.copy_from(branch.memory);
+	registers.jump_register = branch.registers.jump_register;
+	output_byte = branch.output_byte;
+	output_bit_count = branch.output_bit_count;
+	output->write(speculation.output().data(), speculation.output().size());
+	steps = step_count() + branch.step_count();
+	start_countdown();
+	metrics.bits_printed += branch.metrics.bits_printed;
+	if (registers.tallies != NULL) {
+		metrics.lines += branch.metrics.lines;
+		metrics.nands += branch.metrics.nands;
+		metrics.memory_reads += branch.metrics.memory_reads;
+		metrics.memory_writes += branch.metrics.memory_writes;
+	}
+}
+
+#pragma endregion
+
+#pragma region Native code
+
+// Runs a runtime function for native code. Exceptions can't pass through native code, the first one
+// stops it and is thrown again after the native code has returned.
+template<class Result, class Function>
+Result BitInterpreter::guarded(void* context, Function function) {
+	BitInterpreter& interpreter = *(BitInterpreter*)context;
+	try {
+		return function(interpreter);
+	}
+	catch (...) {
+		interpreter.native_error = current_exception();
+		interpreter.registers.stopped = 1;
+		return Result();
+	}
+}
+
+JitRuntime BitInterpreter::native_runtime() {
+	JitRuntime runtime;
+	runtime.memory_write = [](void* context, int address, Value value) {
+		guarded<void>(context, [=](BitInterpreter& interpreter) { interpreter.memory_write(address, value); });
+	};
+	runtime.load_variable = [](void* context, int address) {
+		return guarded<Value>(context, [=](BitInterpreter& interpreter) { return interpreter.load_variable(address); });
+	};
+	runtime.store_bit = [](void* context, int address, Value value) {
+		guarded<void>(context, [=](BitInterpreter& interpreter) { interpreter.store_bit(address, value); });
+	};
+	runtime.nand = [](void* context, Value left, Value right) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return nand(left, right); });
+	};
+	runtime.fused_not = [](void* context, Value value) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return fused_not(value); });
+	};
+	runtime.fused_and = [](void* context, Value left, Value right) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return fused_and(left, right); });
+	};
+	runtime.fused_or = [](void* context, Value left, Value right) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return fused_or(left, right); });
+	};
+	runtime.fused_xor = [](void* context, Value left, Value right) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return fused_xor(left, right); });
+	};
+	runtime.address_of = [](void* context, Value value) {
+		return guarded<Value>(context, [=](BitInterpreter&) { return address_of(value); });
+	};
+	runtime.value_beyond = [](void* context, Value value) {
+		return guarded<Value>(context, [=](BitInterpreter& interpreter) { return interpreter.value_beyond(value); });
+	};
+	runtime.value_at = [](void* context, Value value) {
+		return guarded<Value>(context, [=](BitInterpreter& interpreter) { return interpreter.value_at(value); });
+	};
+	// Printing also grows the output string of batches and the server and the period of the cycle detector.
+	runtime.print_bit = [](void* context, int value) {
+		guarded<void>(context, [=](BitInterpreter& interpreter) { interpreter.print_bit(value); });
+	};
+	runtime.print_bits = [](void* context, const char* bits, int count) {
+		guarded<void>(context, [=](BitInterpreter& interpreter) { interpreter.print_bits(bits, count); });
+	};
+	runtime.read_bit = [](void* context) {
+		return guarded<int>(context, [](BitInterpreter& interpreter) { return interpreter.read_bit(); });
+	};
+	runtime.check_cycle = [](void* context, int line_number) {
+		guarded<void>(context, [=](BitInterpreter& interpreter) { interpreter.check_cycle(line_number); });
+	};
+	runtime.check_limits = [](void* context) {
+		guarded<void>(context, [](BitInterpreter& interpreter) { interpreter.check_limits(); });
+	};
+	return runtime;
+}
+
+void BitInterpreter::run_native(const BitJit& jit, const BytecodeProgram& program) {
+	vector<Value> stack(program.max_stack_depth + 1);
+	jit.run(stack.data(), this, &registers);
+	if (registers.stopped) {
+		rethrow_exception(native_error);
+	}
+}
+
+#pragma endregion
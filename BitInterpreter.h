@@ -0,0 +1,200 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <exception>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "BitValue.h"
+#include "BitMemory.h"
+#include "BitCycleDetector.h"
+#include "BitBytecode.h"
+#include "BitJit.h"
+#include "BitReader.h"
+#include "BitWriter.h"
+#include "BitError.h"
+#include "BitProfile.h"
+#include "BitTrace.h"
+#include "BitMetrics.h"
+
+class BitProgram;
+class BitSpeculation;
+
+enum CycleMode {
+	CYCLES_IGNORED,
+	// An endless loop without input or output is a runtime error.
+	CYCLES_ABORTED,
+	// An endless loop that only prints repeats its output without running, one without output is a runtime error.
+	CYCLES_FAST_FORWARDED
+};
+
+struct BitOptions {
+	bool use_tree_walker = false;
+	bool use_jit = false;
+	bool optimize = true;
+	bool print_ascii = false;
+	bool read_ascii = false;
+	// Batches run the inputs of a program together in the lanes of a BitSlicedProgram.
+	bool use_bit_slicing = false;
+	CycleMode cycle_mode = CYCLES_IGNORED;
+	// A run stops with a BitLimitError after this many lines, zero means no limit.
+	uint64_t max_steps = 0;
+	// The time limit of a run in milliseconds, zero means no limit.
+	int time_limit = 0;
+	// Programs record every line in the trace of the interpreter, they run on the virtual machine or the tree walker.
+	bool trace = false;
+	// Programs tally every line, so the metrics of the interpreter count the lines, NANDs and memory accesses they run.
+	bool count_work = false;
+	// While a READ waits for input, the lines after it run for both values of the bit on other threads and the
+	// branch of the bit that arrives is taken over. Programs run on the virtual machine and always count their steps.
+	bool speculate = false;
+	// A run stops soon after another thread sets the flag.
+	const std::atomic<bool>* cancel = NULL;
+	// Programs run on the memory an earlier run left, as live programs do, so the type inference doesn't
+	// assume that a variable holds bits because the program only stores bits into it.
+	bool kept_memory = false;
+
+	bool has_limits() const { return max_steps != 0 || time_limit != 0 || cancel != NULL; };
+};
+
+/// <summary>
+/// The memory and the jump register of an interpreter, saved after a run. The memory pages are shared
+/// copy-on-write, saving a state and starting runs from it only copies the pages these runs write.
+/// A saved state doesn't change, runs on several threads can start from the same one.
+/// </summary>
+struct BitSnapshot {
+	BitMemory memory;
+	int jump_register = 0;
+};
+
+/// <summary>
+/// The execution context of BIT programs: the memory, the jump register and the input and output
+/// streams. Every run starts with cleared memory. Runtime errors are thrown as BitError, the output
+/// printed before the error stays in the writer.
+/// Interpreters share no state, each thread can run programs on its own interpreter.
+/// </summary>
+class BitInterpreter
+{
+	friend class BitSpeculation;
+
+public:
+	BitOptions options;
+	// The jump register, shared with native code.
+	JitState registers;
+	// Counts the lines, gotos and memory accesses of the tree walking interpreter if not NULL.
+	BitProfile* profile;
+	// Records the lines and writes of programs compiled with tracing if not NULL.
+	BitTrace* trace;
+	// Summed over every run of the interpreter, the host adds the parse times.
+	BitMetrics metrics;
+
+	BitInterpreter(BitReader& input, BitWriter& output, const BitOptions& options);
+	BitInterpreter(const BitInterpreter&) = delete;
+	BitInterpreter& operator=(const BitInterpreter&) = delete;
+
+	void run(const BitProgram& program);
+	// Runs the program with the memory and the jump register of the snapshot instead of cleared ones.
+	void run(const BitProgram& program, const BitSnapshot& start);
+	void save(BitSnapshot& snapshot) const;
+	// The lines the last run started, only counted if the options have limits.
+	uint64_t step_count() const;
+
+	Value memory_read(int address);
+	void memory_write(int address, Value value);
+	// The jump register or a variable, for addresses of the program that are already checked.
+	inline Value load_variable(int address) {
+		if (profile != NULL) {
+			profile->read(address);
+		}
+		if (address == jump_register_address) {
+			return Value::make(registers.jump_register, BIT);
+		}
+		return memory.read(address);
+	}
+	// Stores a bit into the jump register or a variable, for stores the type inference proved well typed.
+	// The jump register still checks for addresses, see CodeNode::infer_types().
+	inline void store_bit(int address, Value value) {
+		if (profile != NULL) {
+			profile->write(address);
+		}
+#ifdef BIT_TRACING
+		if (trace != NULL) {
+			trace->write(address, value);
+		}
+#endif
+		if (address == jump_register_address) {
+			if (value.type() == ADDRESS_OF_A_BIT) {
+				fail("The jump register can't store address-of-a-bit values.");
+			}
+			registers.jump_register = value.payload();
+			return;
+		}
+		if (cycle_mode != CYCLES_IGNORED) {
+			cycle_detector.write(address, memory.read(address), value);
+		}
+		memory.write(address, value);
+	}
+	Value value_beyond(Value value);
+	Value value_at(Value value);
+	void print_bit(int value);
+	void print_bits(const char* bits, int count);
+	int read_bit();
+	void check_cycle(int line_number);
+	// Counts a line, the limits are checked when the countdown runs out.
+	inline void step() {
+		if (--registers.countdown == 0) {
+			check_limits();
+		}
+	}
+	void check_limits();
+	[[noreturn]] static void fail(const std::string& message);
+
+	static Value nand(Value left, Value right);
+	static Value fused_not(Value value);
+	static Value fused_and(Value left, Value right);
+	static Value fused_or(Value left, Value right);
+	static Value fused_xor(Value left, Value right);
+	static Value address_of(Value value);
+	// The runtime functions for machine code, the context is the interpreter.
+	static JitRuntime native_runtime();
+
+private:
+	BitMemory memory;
+	BitCycleDetector cycle_detector;
+	BitReader* input;
+	BitWriter* output;
+	// Bits of the character that is printed or read in ASCII mode, the most significant bit comes first.
+	uint8_t output_byte;
+	int output_bit_count;
+	uint8_t input_byte;
+	int input_bit_count;
+	// The cycle mode of the current run, a loop that only prints turns the detection off.
+	CycleMode cycle_mode;
+	// An error of a runtime function called by native code, thrown again after it returned.
+	std::exception_ptr native_error;
+	// The lines run before the current countdown started and the length of the countdown.
+	uint64_t steps;
+	int step_batch;
+	std::chrono::steady_clock::time_point deadline;
+	// The run counts of the lines of a counted program.
+	std::vector<uint64_t> tallies;
+	// The program of the current run, and the instruction the virtual machine stopped at, a HALT or the READ
+	// a speculative branch stopped before.
+	const BitProgram* running;
+	int stop_pc;
+	bool speculative;
+
+	void reset();
+	void start_countdown();
+	void check_time();
+	// Ends a loop that was recognized in a run with a step limit.
+	[[noreturn]] void fast_forward_to_step_limit();
+	// Bytecode starts at the instruction if it isn't negative.
+	void execute(const BitProgram& program, int pc = -1);
+	void count_run(const BitProgram& program, std::chrono::steady_clock::time_point start, bool failed);
+	void run_bytecode(const BytecodeProgram& program, int pc);
+	int read_speculatively(int pc);
+	void commit(BitSpeculation& speculation);
+	void run_native(const BitJit& jit, const BytecodeProgram& program);
+	template<class Result, class Function> static Result guarded(void* context, Function function);
+};
@@ -0,0 +1,450 @@
+#include "BitJit.h"
+#include <cstring>
+#include <cstddef>
+
+#ifdef BIT_JIT_SUPPORTED
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+// Register usage of the generated code:
+//   rbx  the jump register
+//   r12  the value stack pointer, it points to the next free slot, every value is 4 bytes
+//   r13  the JitState of the interpreter
+//   r14  the context, the first argument of every runtime function
+// All four are callee-saved in the System V and the Windows x64 calling conventions.
+
+static_assert(offsetof(JitState, stopped) == 4, "Native code reads stopped at [r13 + 4].");
+static_assert(offsetof(JitState, countdown) == 8, "Native code counts the steps at [r13 + 8].");
+static_assert(offsetof(JitState, tallies) == 16, "Native code loads the tallies from [r13 + 16].");
+
+static const int r12 = 12;
+static const int r13 = 13;
+static const int r14 = 14;
+
+#ifdef _WIN32
+static const uint8_t argument_registers[] = { 1, 2, 8 };	// rcx, rdx, r8
+#else
+static const uint8_t argument_registers[] = { 7, 6, 2 };	// rdi, rsi, rdx
+#endif
+
+// Four pushes plus the return address leave the stack 8 bytes off, 40 more bytes realign it
+// and include the 32 bytes of shadow space the Windows calling convention requires.
+static const uint8_t frame_size = 40;
+
+
+BitJit::BitJit(const JitRuntime& runtime) : runtime(runtime), executable(NULL), executable_size(0)
+{
+}
+
+
+BitJit::~BitJit()
+{
+	free_executable();
+}
+
+
+bool BitJit::is_supported()
+{
+#ifdef BIT_JIT_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+bool BitJit::compile(const BytecodeProgram& program)
+{
+#ifdef BIT_JIT_SUPPORTED
+	for (const Instruction& instruction : program.code) {
+		if (instruction.op == OP_JMP_IND) {
+			return false;
+		}
+	}
+
+	code.clear();
+	exits.clear();
+	std::vector<size_t> labels(program.code.size());
+	std::vector<std::pair<size_t, int>> jumps;
+
+	// Prologue
+	emit({ 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56 });					// push rbx, r12, r13, r14
+	emit({ 0x48, 0x83, 0xEC, frame_size });								// sub rsp, frame_size
+	emit_move_register(r12, argument_registers[0]);						// mov r12, stack
+	emit_move_register(r14, argument_registers[1]);						// mov r14, context
+	emit_move_register(r13, argument_registers[2]);						// mov r13, state
+	emit({ 0x41, 0x8B, 0x5D, 0x00 });									// mov ebx, [r13]
+	emit({ 0xE9 });														// jmp entry
+	jumps.push_back({ code.size(), program.entry });
+	emit32(0);
+
+	for (size_t pc = 0; pc < program.code.size(); pc++) {
+		labels[pc] = code.size();
+		const Instruction& instruction = program.code[pc];
+		switch (instruction.op) {
+		case OP_PUSH_CONST:
+		case OP_PUSH_BIT:
+			emit({ 0x41, 0xC7, 0x04, 0x24 });								// mov dword [r12], value
+			emit32(Value::make(instruction.operand, instruction.op == OP_PUSH_BIT ? BIT : UNDEFINED).word);
+			emit({ 0x49, 0x83, 0xC4, 0x04 });								// add r12, 4
+			break;
+		case OP_LOAD_VAR:
+			if (instruction.operand == -1) {
+				emit({ 0x8D, 0x04, 0x9D });									// lea eax, [rbx * 4 + BIT]
+				emit32(BIT);
+			}
+			else {
+				emit_move_argument(1, instruction.operand);
+				emit_call((const void*)runtime.load_variable, false);
+			}
+			emit({ 0x41, 0x89, 0x04, 0x24 });								// mov [r12], eax
+			emit({ 0x49, 0x83, 0xC4, 0x04 });								// add r12, 4
+			break;
+		case OP_LOAD_IND:
+		case OP_ADDR_OF:
+		case OP_BEYOND:
+			emit_load_argument(1, -4);
+			emit_call(instruction.op == OP_LOAD_IND ? (const void*)runtime.value_at
+				: instruction.op == OP_ADDR_OF ? (const void*)runtime.address_of
+				: (const void*)runtime.value_beyond);
+			emit({ 0x41, 0x89, 0x44, 0x24, 0xFC });							// mov [r12 - 4], eax
+			break;
+		case OP_NAND: {
+			// Both operands are bits if no bit but the type bit and the payload bit is set in either.
+			emit({ 0x41, 0x8B, 0x44, 0x24, 0xF8 });							// mov eax, [r12 - 8]
+			emit({ 0x41, 0x8B, 0x4C, 0x24, 0xFC });							// mov ecx, [r12 - 4]
+			emit({ 0x89, 0xC2, 0x09, 0xCA });								// mov edx, eax; or edx, ecx
+			emit({ 0xF7, 0xC2 });											// test edx, ~(payload bit | BIT)
+			emit32(~(uint32_t)((1 << Value::type_bits) | BIT));
+			emit({ 0x75 });													// jnz slow
+			size_t slow = code.size();
+			emit({ 0x00 });
+			emit({ 0x21, 0xC8 });											// and eax, ecx
+			emit({ 0x83, 0xE0, 1 << Value::type_bits });					// and eax, payload bit
+			emit({ 0x83, 0xF0, (1 << Value::type_bits) | BIT });			// xor eax, payload bit | BIT
+			emit({ 0x41, 0x89, 0x44, 0x24, 0xF8 });							// mov [r12 - 8], eax
+			emit({ 0xEB });													// jmp done
+			size_t done = code.size();
+			emit({ 0x00 });
+			// The interpreter reports the type error.
+			patch8(slow, code.size());
+			emit_load_argument(1, -8);
+			emit_load_argument(2, -4);
+			emit_call((const void*)runtime.nand);
+			emit({ 0x41, 0x89, 0x44, 0x24, 0xF8 });							// mov [r12 - 8], eax
+			patch8(done, code.size());
+			emit({ 0x49, 0x83, 0xEC, 0x04 });								// sub r12, 4
+			break;
+		}
+		case OP_NOT:
+			emit_load_argument(1, -4);
+			emit_call((const void*)runtime.fused_not);
+			emit({ 0x41, 0x89, 0x44, 0x24, 0xFC });							// mov [r12 - 4], eax
+			break;
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+			emit_load_argument(1, -8);
+			emit_load_argument(2, -4);
+			emit_call(instruction.op == OP_AND ? (const void*)runtime.fused_and
+				: instruction.op == OP_OR ? (const void*)runtime.fused_or
+				: (const void*)runtime.fused_xor);
+			emit({ 0x41, 0x89, 0x44, 0x24, 0xF8 });							// mov [r12 - 8], eax
+			emit({ 0x49, 0x83, 0xEC, 0x04 });								// sub r12, 4
+			break;
+		case OP_STORE:
+			if (instruction.operand == -1) {
+				// Undefined values and bits of the bit type are stored inline.
+				emit({ 0x41, 0x8B, 0x44, 0x24, 0xFC });						// mov eax, [r12 - 4]
+				emit({ 0xA8, Value::type_mask, 0x74 });						// test al, type mask; jz store
+				size_t store = code.size();
+				emit({ 0x00 });
+				emit({ 0x89, 0xC1 });										// mov ecx, eax
+				emit({ 0x83, 0xE1, (uint8_t)~(1 << Value::type_bits) });	// and ecx, ~payload bit
+				emit({ 0x83, 0xF9, BIT, 0x75 });							// cmp ecx, BIT; jne slow
+				size_t slow = code.size();
+				emit({ 0x00 });
+				patch8(store, code.size());
+				emit({ 0x89, 0xC3 });										// mov ebx, eax
+				emit({ 0xC1, 0xFB, Value::type_bits });						// sar ebx, type bits
+				emit({ 0xEB });												// jmp done
+				size_t done = code.size();
+				emit({ 0x00 });
+				// The interpreter reports the illegal value.
+				patch8(slow, code.size());
+				emit_move_argument(1, -1);
+				emit_load_argument(2, -4);
+				emit_call((const void*)runtime.memory_write);
+				patch8(done, code.size());
+			}
+			else {
+				emit_move_argument(1, instruction.operand);
+				emit_load_argument(2, -4);
+				emit_call((const void*)runtime.memory_write);
+			}
+			emit({ 0x49, 0x83, 0xEC, 0x04 });								// sub r12, 4
+			break;
+		case OP_STORE_BIT:
+			if (instruction.operand == -1) {
+				// A variable may still hold an address from before a run that started from a snapshot.
+				emit({ 0x41, 0x8B, 0x44, 0x24, 0xFC });						// mov eax, [r12 - 4]
+				emit({ 0xA8, ADDRESS_OF_A_BIT, 0x75 });						// test al, address type; jnz slow
+				size_t slow = code.size();
+				emit({ 0x00 });
+				emit({ 0x89, 0xC3 });										// mov ebx, eax
+				emit({ 0xC1, 0xFB, Value::type_bits });						// sar ebx, type bits
+				emit({ 0xEB });												// jmp done
+				size_t done = code.size();
+				emit({ 0x00 });
+				// The interpreter reports the address.
+				patch8(slow, code.size());
+				emit_move_argument(1, -1);
+				emit_load_argument(2, -4);
+				emit_call((const void*)runtime.memory_write);
+				patch8(done, code.size());
+			}
+			else {
+				emit_move_argument(1, instruction.operand);
+				emit_load_argument(2, -4);
+				emit_call((const void*)runtime.store_bit);
+			}
+			emit({ 0x49, 0x83, 0xEC, 0x04 });								// sub r12, 4
+			break;
+		case OP_STORE_IND: {
+			emit_load_argument(1, -8);
+			// The address is the payload of the value.
+			int reg = argument_registers[1];
+			if (reg >= 8) {
+				emit({ 0x41 });
+			}
+			emit({ 0xC1, (uint8_t)(0xF8 | (reg & 7)), Value::type_bits });	// sar arg32, type bits
+			emit_load_argument(2, -4);
+			emit_call((const void*)runtime.memory_write);
+			emit({ 0x49, 0x83, 0xEC, 0x08 });								// sub r12, 8
+			break;
+		}
+		case OP_PRINT:
+			emit_move_argument(1, instruction.operand);
+			emit_call((const void*)runtime.print_bit);
+			break;
+		case OP_PRINT_BITS: {
+			const std::string& bits = program.strings[instruction.operand];
+			emit_move_argument64(1, (uint64_t)bits.data());
+			emit_move_argument(2, (int)bits.size());
+			emit_call((const void*)runtime.print_bits);
+			break;
+		}
+		case OP_READ:
+			emit_call((const void*)runtime.read_bit);
+			emit({ 0x89, 0xC3 });											// mov ebx, eax
+			break;
+		case OP_JMP:
+			emit({ 0xE9 });													// jmp operand
+			jumps.push_back({ code.size(), instruction.operand });
+			emit32(0);
+			break;
+		case OP_JZ:
+		case OP_JO:
+			if (instruction.op == OP_JZ) {
+				emit({ 0x85, 0xDB });										// test ebx, ebx
+			}
+			else {
+				emit({ 0x83, 0xFB, 0x01 });									// cmp ebx, 1
+			}
+			emit({ 0x0F, 0x84 });											// je operand
+			jumps.push_back({ code.size(), instruction.operand });
+			emit32(0);
+			break;
+		case OP_CYCLE:
+			emit_move_argument(1, instruction.operand);
+			emit_call((const void*)runtime.check_cycle);
+			break;
+		case OP_STEP: {
+			emit({ 0x41, 0xFF, 0x4D, 0x08 });								// dec dword [r13 + 8]
+			emit({ 0x75 });													// jnz next
+			size_t next = code.size();
+			emit({ 0x00 });
+			emit_call((const void*)runtime.check_limits);
+			patch8(next, code.size());
+			break;
+		}
+		case OP_TALLY:
+			emit({ 0x49, 0x8B, 0x45, 0x10 });								// mov rax, [r13 + 16]
+			emit({ 0x48, 0xFF, 0x80 });										// inc qword [rax + index * 8]
+			emit32((uint32_t)instruction.operand * 8);
+			break;
+		case OP_HALT:
+			emit_exit();
+			break;
+		default:
+			return false;
+		}
+	}
+
+	// Epilogue
+	size_t epilogue = code.size();
+	emit({ 0x41, 0x89, 0x5D, 0x00 });									// mov [r13], ebx
+	emit({ 0x48, 0x83, 0xC4, frame_size });								// add rsp, frame_size
+	emit({ 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3 });			// pop r14, r13, r12, rbx; ret
+
+	for (auto& jump : jumps) {
+		patch32(jump.first, labels[jump.second]);
+	}
+	for (size_t exit : exits) {
+		patch32(exit, epilogue);
+	}
+
+	free_executable();
+	executable_size = code.size();
+#ifdef _WIN32
+	executable = VirtualAlloc(NULL, executable_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (executable == NULL) {
+		return false;
+	}
+	memcpy(executable, code.data(), code.size());
+	DWORD old_protection;
+	if (!VirtualProtect(executable, executable_size, PAGE_EXECUTE_READ, &old_protection)) {
+		free_executable();
+		return false;
+	}
+#else
+	executable = mmap(NULL, executable_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (executable == MAP_FAILED) {
+		executable = NULL;
+		return false;
+	}
+	memcpy(executable, code.data(), code.size());
+	if (mprotect(executable, executable_size, PROT_READ | PROT_EXEC) != 0) {
+		free_executable();
+		return false;
+	}
+#endif
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+void BitJit::run(Value* stack, void* context, JitState* state) const
+{
+	if (executable != NULL) {
+		((void(*)(Value*, void*, JitState*))executable)(stack, context, state);
+	}
+}
+
+
+void BitJit::emit(std::initializer_list<uint8_t> bytes)
+{
+	code.insert(code.end(), bytes);
+}
+
+
+void BitJit::emit32(uint32_t value)
+{
+	for (int i = 0; i < 4; i++) {
+		code.push_back((uint8_t)(value >> (i * 8)));
+	}
+}
+
+
+void BitJit::emit64(uint64_t value)
+{
+	emit32((uint32_t)value);
+	emit32((uint32_t)(value >> 32));
+}
+
+
+void BitJit::patch32(size_t at, size_t target)
+{
+	uint32_t relative = (uint32_t)(target - (at + 4));
+	memcpy(&code[at], &relative, 4);
+}
+
+
+void BitJit::patch8(size_t at, size_t target)
+{
+	code[at] = (uint8_t)(target - (at + 1));
+}
+
+
+void BitJit::emit_exit()
+{
+	emit({ 0xE9 });		// jmp epilogue
+	exits.push_back(code.size());
+	emit32(0);
+}
+
+
+void BitJit::emit_move_register(int destination, int source)
+{
+	// mov destination, source
+	emit({ (uint8_t)(0x48 | ((source >> 3) << 2) | (destination >> 3)), 0x89, (uint8_t)(0xC0 | ((source & 7) << 3) | (destination & 7)) });
+}
+
+
+void BitJit::emit_load_argument(int argument, int displacement)
+{
+	// mov arg32, [r12 + displacement]
+	int reg = argument_registers[argument];
+	emit({ (uint8_t)(0x41 | ((reg >> 3) << 2)), 0x8B, (uint8_t)(0x44 | ((reg & 7) << 3)), 0x24, (uint8_t)displacement });
+}
+
+
+void BitJit::emit_move_argument(int argument, int value)
+{
+	// mov arg32, value
+	int reg = argument_registers[argument];
+	if (reg >= 8) {
+		emit({ 0x41 });
+	}
+	emit({ (uint8_t)(0xB8 + (reg & 7)) });
+	emit32((uint32_t)value);
+}
+
+
+void BitJit::emit_move_argument64(int argument, uint64_t value)
+{
+	// mov arg, value
+	int reg = argument_registers[argument];
+	emit({ (uint8_t)(0x48 | (reg >> 3)), (uint8_t)(0xB8 + (reg & 7)) });
+	emit64(value);
+}
+
+
+void BitJit::emit_call(const void* function, bool can_fail)
+{
+	emit({ 0x41, 0x89, 0x5D, 0x00 });					// mov [r13], ebx
+	emit_move_register(argument_registers[0], r14);		// mov arg0, context
+	emit({ 0x48, 0xB8 });								// mov rax, function
+	emit64((uint64_t)function);
+	emit({ 0xFF, 0xD0 });								// call rax
+	emit({ 0x41, 0x8B, 0x5D, 0x00 });					// mov ebx, [r13]
+	if (can_fail) {
+		emit({ 0x41, 0x83, 0x7D, 0x04, 0x00 });			// cmp dword [r13 + 4], 0
+		emit({ 0x0F, 0x85 });							// jne epilogue
+		exits.push_back(code.size());
+		emit32(0);
+	}
+}
+
+
+void BitJit::free_executable()
+{
+	if (executable == NULL) {
+		return;
+	}
+#ifdef BIT_JIT_SUPPORTED
+#ifdef _WIN32
+	VirtualFree(executable, 0, MEM_RELEASE);
+#else
+	munmap(executable, executable_size);
+#endif
+#endif
+	executable = NULL;
+	executable_size = 0;
+}
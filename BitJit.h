@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <initializer_list>
+#include <cstdint>
+#include <cstddef>
+#include "BitValue.h"
+#include "BitBytecode.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BIT_JIT_SUPPORTED
+#endif
+
+/// <summary>
+/// The registers native code shares with the interpreter. The jump register is kept in a machine
+/// register and written back before every call. Exceptions can't pass through native code, so a
+/// runtime function that fails sets stopped instead and native code returns after the call.
+/// Native code counts the countdown down at every line and calls check_limits when it reaches zero.
+/// </summary>
+struct JitState {
+	int jump_register;
+	int stopped;
+	int countdown;
+	// The run counts of the lines of a program compiled with OP_TALLY, NULL for other programs.
+	uint64_t* tallies;
+};
+
+/// <summary>
+/// The functions of the interpreter that native code calls back into, the first argument is the
+/// context passed to BitJit::run().
+/// </summary>
+struct JitRuntime {
+	void(*memory_write)(void* context, int address, Value value);
+	Value(*load_variable)(void* context, int address);
+	void(*store_bit)(void* context, int address, Value value);
+	Value(*nand)(void* context, Value left, Value right);
+	Value(*fused_not)(void* context, Value value);
+	Value(*fused_and)(void* context, Value left, Value right);
+	Value(*fused_or)(void* context, Value left, Value right);
+	Value(*fused_xor)(void* context, Value left, Value right);
+	Value(*address_of)(void* context, Value value);
+	Value(*value_beyond)(void* context, Value value);
+	Value(*value_at)(void* context, Value value);
+	void(*print_bit)(void* context, int value);
+	void(*print_bits)(void* context, const char* bits, int count);
+	int(*read_bit)(void* context);
+	void(*check_cycle)(void* context, int line_number);
+	void(*check_limits)(void* context);
+};
+
+/// <summary>
+/// Translates bytecode into x86-64 machine code, one block per line.
+/// NAND, jump register accesses and constant gotos are emitted inline, memory accesses, the
+/// fused NAND operations and the pointer operators call back into the interpreter so the
+/// runtime checks stay the same.
+/// Programs with GOTO VARIABLE are not compiled and run on the virtual machine instead.
+/// The machine code doesn't depend on the context, a compiled program can run in several interpreters.
+/// </summary>
+class BitJit
+{
+public:
+	BitJit(const JitRuntime& runtime);
+	~BitJit();
+	BitJit(const BitJit&) = delete;
+	BitJit& operator=(const BitJit&) = delete;
+
+	static bool is_supported();
+	bool compile(const BytecodeProgram& program);
+	// The stack must hold at least max_stack_depth values of the compiled program.
+	void run(Value* stack, void* context, JitState* state) const;
+
+private:
+	JitRuntime runtime;
+	std::vector<uint8_t> code;
+	// Jumps to the epilogue, patched when the code is complete.
+	std::vector<size_t> exits;
+	void* executable;
+	size_t executable_size;
+
+	void emit(std::initializer_list<uint8_t> bytes);
+	void emit32(uint32_t value);
+	void emit64(uint64_t value);
+	void patch32(size_t at, size_t target);
+	void patch8(size_t at, size_t target);
+	void emit_exit();
+	void emit_move_register(int destination, int source);
+	void emit_load_argument(int argument, int displacement);
+	void emit_move_argument(int argument, int value);
+	void emit_move_argument64(int argument, uint64_t value);
+	void emit_call(const void* function, bool can_fail = true);
+	void free_executable();
+};
@@ -1,7 +1,35 @@
 #include "BitLexer.h"
+#include <cstdint>
+#include <climits>
 
+// The first entries are in the order of TokenType, ZERO and ONE become TOKEN_BITS.
+static const char* keywords[] = {
+	"LINENUMBER",
+	"CODE",
+	"GOTO",
+	"IFTHEJUMPREGISTERIS",
+	"EQUALTO",
+	"PRINT",
+	"READ",
+	"EQUALS",
+	"VARIABLE",
+	"THEJUMPREGISTER",
+	"NAND",
+	"THEADDRESSOF",
+	"THEVALUEBEYOND",
+	"THEVALUEAT",
+	"OPENPARENTHESIS",
+	"CLOSEPARENTHESIS",
+	"ZERO",
+	"ONE"
+};
+static const int keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+static const int ZERO = 16;
+static const int ONE = 17;
+static const char DELIMITER = ';';
 
-BitLexer::BitLexer()
+
+BitLexer::BitLexer(BitReader& reader) : reader(reader), has_pending(false)
 {
 }
 
@@ -9,3 +37,113 @@ BitLexer::BitLexer()
 BitLexer::~BitLexer()
 {
 }
+
+
+Token BitLexer::next()
+{
+	if (has_pending) {
+		has_pending = false;
+		return pending;
+	}
+	Token token = scan();
+	if (token.type != TOKEN_BITS) {
+		return token;
+	}
+	// Fold the following bits into the token, the first token after them is kept for the next call.
+	for (;;) {
+		Token following = scan();
+		if (following.type != TOKEN_BITS) {
+			pending = following;
+			has_pending = true;
+			return token;
+		}
+		// A constant that doesn't fit into an int stays at the largest int, the parser rejects it as too large.
+		token.value = token.value > (INT_MAX >> 1) ? INT_MAX : (token.value << 1) | following.value;
+		token.bit_count++;
+	}
+}
+
+
+const char* BitLexer::spelling(TokenType type)
+{
+	if (type < TOKEN_BITS) {
+		return keywords[type];
+	}
+	switch (type) {
+	case TOKEN_BITS:
+		return "Bit constant";
+	case TOKEN_DELIMITER:
+		return ";";
+	case TOKEN_END:
+		return "End of input";
+	default:
+		return "Invalid symbol";
+	}
+}
+
+
+Token BitLexer::scan()
+{
+	reader.skip_whitespace();
+	Token token = { TOKEN_INVALID, 0, 0, reader.offset() };
+	int character = reader.peek();
+	if (character == EOF) {
+		token.type = TOKEN_END;
+		return token;
+	}
+	if (character == DELIMITER) {
+		reader.advance();
+		token.type = TOKEN_DELIMITER;
+		return token;
+	}
+
+	// Narrow down the keywords that start with the characters read so far until one is left,
+	// then match the rest of it.
+	uint32_t candidates = 0;
+	for (int i = 0; i < keyword_count; i++) {
+		if (keywords[i][0] == character) {
+			candidates |= 1u << i;
+		}
+	}
+	if (candidates == 0) {
+		return token;
+	}
+	int length = 1;
+	reader.advance();
+	while ((candidates & (candidates - 1)) != 0) {
+		reader.skip_whitespace();
+		character = reader.peek();
+		uint32_t matching = 0;
+		for (int i = 0; i < keyword_count; i++) {
+			if ((candidates & (1u << i)) != 0 && keywords[i][length] == character) {
+				matching |= 1u << i;
+			}
+		}
+		if (matching == 0) {
+			return token;
+		}
+		candidates = matching;
+		length++;
+		reader.advance();
+	}
+	int keyword = 0;
+	while ((candidates & (1u << keyword)) == 0) {
+		keyword++;
+	}
+	for (const char* rest = keywords[keyword] + length; *rest != '\0'; rest++) {
+		reader.skip_whitespace();
+		if (reader.peek() != *rest) {
+			return token;
+		}
+		reader.advance();
+	}
+	if (keyword == ZERO || keyword == ONE) {
+		token.type = TOKEN_BITS;
+		token.value = (keyword == ONE) ? 1 : 0;
+		token.bit_count = 1;
+	}
+	else {
+		token.type = (TokenType)keyword;
+	}
+	return token;
+}
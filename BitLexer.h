@@ -1,8 +1,56 @@
 #pragma once
+#include "BitReader.h"
+
+enum TokenType {
+	TOKEN_LINE_NUMBER,
+	TOKEN_CODE,
+	TOKEN_GOTO,
+	TOKEN_IF_THE_JUMP_REGISTER_IS,
+	TOKEN_EQUAL_TO,
+	TOKEN_PRINT,
+	TOKEN_READ,
+	TOKEN_EQUALS,
+	TOKEN_VARIABLE,
+	TOKEN_THE_JUMP_REGISTER,
+	TOKEN_NAND,
+	TOKEN_THE_ADDRESS_OF,
+	TOKEN_THE_VALUE_BEYOND,
+	TOKEN_THE_VALUE_AT,
+	TOKEN_OPEN_PARENTHESIS,
+	TOKEN_CLOSE_PARENTHESIS,
+	// A run of ZERO and ONE keywords, folded into one integer.
+	TOKEN_BITS,
+	// Ends a program, so that a source can contain several programs that span any number of lines.
+	TOKEN_DELIMITER,
+	TOKEN_INVALID,
+	TOKEN_END
+};
+
+struct Token {
+	TokenType type;
+	int value;
+	int bit_count;
+	int offset;
+};
+
+/// <summary>
+/// Splits BIT source code into tokens in a single pass over a BitReader.
+/// Whitespace is allowed anywhere, even inside of keywords, so keywords are matched character by character
+/// while skipping whitespace. No keyword is a prefix of another one, so the lexer never has to back up.
+/// Every token stores the offset of its first character in the source.
+/// </summary>
 class BitLexer
 {
 public:
-	BitLexer();
+	BitLexer(BitReader& reader);
 	~BitLexer();
-};
+	Token next();
+	static const char* spelling(TokenType type);
 
+private:
+	BitReader& reader;
+	Token pending;
+	bool has_pending;
+
+	Token scan();
+};
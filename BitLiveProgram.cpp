@@ -0,0 +1,217 @@
+#include "BitLiveProgram.h"
+#include <cstring>
+#include <map>
+#include <unordered_set>
+#include "BitParser.h"
+#include "BitLexer.h"
+#include "BitNodes.h"
+
+using namespace std;
+
+
+BitLiveProgram::BitLiveProgram(const BitOptions& options) : options(options), replaced_lines(0)
+{
+	// The types of a version can't rely on the memory the versions before left.
+	this->options.kept_memory = true;
+}
+
+
+BitLiveProgram::~BitLiveProgram()
+{
+}
+
+
+int BitLiveProgram::update(const char* begin, const char* end)
+{
+	vector<Record> split_records;
+	if (!split(begin, end, split_records)) {
+		// The parser reports the error, or the lexer was stricter than the parser and every line is parsed.
+		int parsed = parse(begin, end);
+		records.clear();
+		return parsed;
+	}
+	if (current == NULL || replaced_lines >= records.size()) {
+		int parsed = parse(begin, end);
+		remember(begin, split_records);
+		return parsed;
+	}
+	return patch(begin, end, split_records);
+}
+
+
+void BitLiveProgram::run(BitInterpreter& interpreter)
+{
+	try {
+		interpreter.run(*current, state);
+	}
+	catch (...) {
+		interpreter.save(state);
+		throw;
+	}
+	interpreter.save(state);
+}
+
+
+void BitLiveProgram::clear_state()
+{
+	state.memory.clear();
+	state.jump_register = 0;
+}
+
+
+// Finds the line records of the first program, a record reaches from its LINE NUMBER to the next one.
+// False if the program isn't a sequence of lines with distinct numbers.
+bool BitLiveProgram::split(const char* begin, const char* end, vector<Record>& split_records)
+{
+	BitReader reader(begin, end);
+	BitLexer lexer(reader);
+	unordered_set<int> line_numbers;
+	for (;;) {
+		Token token = lexer.next();
+		if (token.type == TOKEN_DELIMITER || token.type == TOKEN_END) {
+			if (split_records.empty()) {
+				return false;
+			}
+			split_records.back().end = token.offset;
+			return true;
+		}
+		if (token.type == TOKEN_INVALID) {
+			return false;
+		}
+		if (token.type == TOKEN_LINE_NUMBER) {
+			Token number = lexer.next();
+			if (number.type != TOKEN_BITS || !line_numbers.insert(number.value).second) {
+				return false;
+			}
+			if (!split_records.empty()) {
+				split_records.back().end = token.offset;
+			}
+			split_records.push_back({ number.value, token.offset, token.offset });
+		}
+		else if (split_records.empty()) {
+			return false;
+		}
+	}
+}
+
+
+int BitLiveProgram::parse(const char* begin, const char* end)
+{
+	BitReader source(begin, end);
+	BitParser parser(source);
+	CodeNode* code = parser.parse(options.optimize);
+	current.reset(new BitProgram(code, options));
+	replaced_lines = 0;
+	return (int)code->lines.size();
+}
+
+
+int BitLiveProgram::patch(const char* begin, const char* end, const vector<Record>& split_records)
+{
+	CodeNode& code = *current->code;
+	BitReader source(begin, end);
+	BitParser parser(source);
+
+	// The changed records are parsed aside first, a syntax error leaves the program as it was.
+	map<int, LineNode> parsed;
+	unordered_set<int> line_numbers;
+	for (const Record& record : split_records) {
+		line_numbers.insert(record.line_number);
+		auto found = records.find(record.line_number);
+		size_t length = (size_t)(record.end - record.begin);
+		if (found != records.end() && found->second.text.size() == length
+			&& memcmp(found->second.text.data(), begin + record.begin, length) == 0) {
+			continue;
+		}
+		source.seek(record.begin);
+		parser.parse_record(code.arena, parsed);
+	}
+
+	// Patches the lines and remembers what they were, so a goto without a target can undo the patch.
+	struct Saved {
+		int line_number;
+		bool existed;
+		InstructionNode* instruction;
+		GotoNode* go;
+		int position;
+	};
+	vector<Saved> saved;
+	for (auto line = code.lines.begin(); line != code.lines.end(); ) {
+		if (line_numbers.count(line->first) == 0) {
+			saved.push_back({ line->first, true, line->second.instruction, line->second.go, line->second.position });
+			line = code.lines.erase(line);
+		}
+		else {
+			++line;
+		}
+	}
+	for (auto& entry : parsed) {
+		auto inserted = code.lines.try_emplace(entry.first);
+		LineNode& line = inserted.first->second;
+		saved.push_back({ entry.first, !inserted.second, line.instruction, line.go, line.position });
+		line.line_number = entry.first;
+		line.instruction = entry.second.instruction;
+		line.go = entry.second.go;
+		line.position = entry.second.position;
+		if (options.optimize) {
+			line.instruction->optimize(code.arena);
+		}
+	}
+	int first_line_number = code.first_line_number;
+	code.first_line_number = split_records.front().line_number;
+
+	int missing_line_number;
+	GotoNode* unresolved = code.link(missing_line_number);
+	if (unresolved != NULL) {
+		// An unchanged line reports the position of its goto in the new source.
+		int position = unresolved->position;
+		for (const Record& record : split_records) {
+			const LineNode& line = code.lines.at(record.line_number);
+			if (line.go == unresolved && parsed.count(record.line_number) == 0) {
+				position += record.begin - records[record.line_number].offset;
+			}
+		}
+		for (auto undo = saved.rbegin(); undo != saved.rend(); ++undo) {
+			if (undo->existed) {
+				LineNode& line = code.lines[undo->line_number];
+				line.line_number = undo->line_number;
+				line.instruction = undo->instruction;
+				line.go = undo->go;
+				line.position = undo->position;
+			}
+			else {
+				code.lines.erase(undo->line_number);
+			}
+		}
+		code.first_line_number = first_line_number;
+		code.link(missing_line_number);
+		parser.fail_at(position, "No line exists with number " + to_string(missing_line_number));
+	}
+
+	// Unchanged lines and their gotos keep their positions in the new source.
+	for (const Record& record : split_records) {
+		if (parsed.count(record.line_number) != 0) {
+			continue;
+		}
+		int moved = record.begin - records[record.line_number].offset;
+		LineNode& line = code.lines.at(record.line_number);
+		line.position += moved;
+		if (line.go != NULL) {
+			line.go->position += moved;
+		}
+	}
+	replaced_lines += parsed.size();
+	CodeNode* patched = current->code.release();
+	current.reset(new BitProgram(patched, options));
+	remember(begin, split_records);
+	return (int)parsed.size();
+}
+
+
+void BitLiveProgram::remember(const char* begin, const vector<Record>& split_records)
+{
+	records.clear();
+	for (const Record& record : split_records) {
+		records[record.line_number] = { string(begin + record.begin, begin + record.end), record.begin };
+	}
+}
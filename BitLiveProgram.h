@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include "BitInterpreter.h"
+#include "BitProgram.h"
+
+/// <summary>
+/// A program that is updated with new versions of its source, for tools that regenerate a program with
+/// small changes and for editing a program while it runs again and again.
+/// A new version is split into its line records by the lexer and only the records whose text changed are
+/// parsed. The lines of the program are patched in place: removed lines are dropped, changed ones replaced,
+/// and the lines are linked and compiled again. The nodes of replaced lines stay in the arena until there
+/// are as many of them as lines, then the next version is parsed completely.
+/// Every run starts with the memory and the jump register the run before left, also if it failed.
+/// Only the first program of a source is used.
+/// </summary>
+class BitLiveProgram
+{
+public:
+	BitLiveProgram(const BitOptions& options);
+	~BitLiveProgram();
+	BitLiveProgram(const BitLiveProgram&) = delete;
+	BitLiveProgram& operator=(const BitLiveProgram&) = delete;
+
+	// Makes the source the current version, returns the number of line records that were parsed.
+	// Syntax errors are thrown as BitParserError, the program then stays at the version before.
+	int update(const char* begin, const char* end);
+	// Runs the current version, there must be one.
+	void run(BitInterpreter& interpreter);
+	// The next run starts with cleared memory.
+	void clear_state();
+
+	const BitProgram* program() const { return current.get(); };
+
+private:
+	struct Record {
+		int line_number;
+		int begin;
+		int end;
+	};
+
+	struct ParsedRecord {
+		std::string text;
+		int offset;
+	};
+
+	BitOptions options;
+	std::unique_ptr<BitProgram> current;
+	// The records of the current version by line number.
+	std::unordered_map<int, ParsedRecord> records;
+	// The lines parsed into the program since it was parsed completely.
+	size_t replaced_lines;
+	BitSnapshot state;
+
+	static bool split(const char* begin, const char* end, std::vector<Record>& split_records);
+	int parse(const char* begin, const char* end);
+	int patch(const char* begin, const char* end, const std::vector<Record>& split_records);
+	void remember(const char* begin, const std::vector<Record>& split_records);
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+/// <summary>
+/// A source file mapped read-only into memory (mmap, or CreateFileMapping on Windows),
+/// so the lexer can run directly over the bytes of the file without copying them.
+/// </summary>
+class BitMappedFile
+{
+public:
+	BitMappedFile();
+	~BitMappedFile();
+	BitMappedFile(const BitMappedFile&) = delete;
+	BitMappedFile& operator=(const BitMappedFile&) = delete;
+
+	// Fails for files that can't be mapped, like pipes or empty files.
+	bool open(const char* path);
+	void close();
+	const char* begin() const { return data; };
+	const char* end() const { return data + size; };
+
+private:
+	const char* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+};
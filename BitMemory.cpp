@@ -0,0 +1,108 @@
+#include "BitMemory.h"
+#include <cstring>
+
+
+BitMemory::BitMemory()
+{
+}
+
+
+BitMemory::~BitMemory()
+{
+	clear();
+}
+
+
+void BitMemory::clear()
+{
+	for (Page* page : pages) {
+		release(page);
+	}
+	pages.clear();
+}
+
+
+BitMemory::Page* BitMemory::allocate_page(size_t index)
+{
+	if (index >= pages.size()) {
+		pages.resize(index + 1, NULL);
+	}
+	// Value-initialization zeroes the page, which makes every cell an undefined zero.
+	Page* page = new Page();
+	Page* shared = pages[index];
+	if (shared != NULL) {
+		memcpy(page->values, shared->values, sizeof(page->values));
+		release(shared);
+	}
+	pages[index] = page;
+	return page;
+}
+
+
+void BitMemory::release(Page* page)
+{
+	if (page != NULL && page->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete page;
+	}
+}
+
+
+void BitMemory::copy_from(const BitMemory& other)
+{
+	if (&other == this) {
+		return;
+	}
+	for (Page* page : other.pages) {
+		if (page != NULL) {
+			page->references.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	clear();
+	pages = other.pages;
+}
+
+
+size_t BitMemory::page_count() const
+{
+	size_t count = 0;
+	for (const Page* page : pages) {
+		count += page != NULL ? 1 : 0;
+	}
+	return count;
+}
+
+
+bool BitMemory::equals(const BitMemory& other) const
+{
+	size_t count = pages.size() > other.pages.size() ? pages.size() : other.pages.size();
+	for (size_t index = 0; index < count; index++) {
+		const Page* page = index < pages.size() ? pages[index] : NULL;
+		const Page* other_page = index < other.pages.size() ? other.pages[index] : NULL;
+		if (page == other_page) {
+			continue;
+		}
+		if (page != NULL && other_page != NULL) {
+			if (memcmp(page->values, other_page->values, sizeof(page->values)) != 0) {
+				return false;
+			}
+		}
+		else if (!is_empty(page != NULL ? page : other_page)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool BitMemory::is_empty(const Page* page)
+{
+	if (page == NULL) {
+		return true;
+	}
+	for (Value value : page->values) {
+		if (value.word != 0) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "BitValue.h"
+
+/// <summary>
+/// The memory of a BIT program. Cells are stored in flat pages indexed by address,
+/// a page is allocated the first time one of its cells is written.
+/// A cell is the packed word of its value, so a read is one load and equal memories are equal bytes.
+/// Reading a cell that was never written returns an undefined value and allocates nothing.
+/// Copies share their pages, a shared page is copied the first time one of the memories writes to it.
+/// The reference counts are atomic, so memories on different threads can share pages.
+/// </summary>
+class BitMemory
+{
+public:
+	static const int page_bits = 12;
+	static const int page_size = 1 << page_bits;
+
+	BitMemory();
+	~BitMemory();
+	BitMemory(const BitMemory&) = delete;
+	BitMemory& operator=(const BitMemory&) = delete;
+
+	inline Value read(int address) const {
+		size_t index = (size_t)address >> page_bits;
+		if (index >= pages.size() || pages[index] == NULL) {
+			return{ 0 };
+		}
+		return pages[index]->values[address & (page_size - 1)];
+	}
+
+	inline void write(int address, Value value) {
+		get_own_page((size_t)address >> page_bits)->values[address & (page_size - 1)] = value;
+	}
+
+	void clear();
+	// Makes this memory a copy of other that shares its pages, only the pages are counted.
+	void copy_from(const BitMemory& other);
+	// True if every cell has the same value and type, unallocated pages are equal to undefined zeros.
+	bool equals(const BitMemory& other) const;
+	// The allocated pages, shared ones included.
+	size_t page_count() const;
+
+private:
+	struct Page {
+		Value values[page_size];
+		// The number of memories that share the page.
+		std::atomic<int> references{ 1 };
+	};
+
+	std::vector<Page*> pages;
+
+	// The page at index, if it isn't shared with another memory.
+	inline Page* get_own_page(size_t index) {
+		if (index < pages.size() && pages[index] != NULL && pages[index]->references.load(std::memory_order_acquire) == 1) {
+			return pages[index];
+		}
+		return allocate_page(index);
+	}
+
+	// Allocates the page at index or replaces a shared page by a copy.
+	Page* allocate_page(size_t index);
+	static void release(Page* page);
+	static bool is_empty(const Page* page);
+};
@@ -0,0 +1,103 @@
+#include "BitMetrics.h"
+#include <algorithm>
+
+using namespace std;
+
+
+void BitMetrics::add(const BitMetrics& other)
+{
+	parses += other.parses;
+	runs += other.runs;
+	failed_runs += other.failed_runs;
+	lines += other.lines;
+	nands += other.nands;
+	memory_reads += other.memory_reads;
+	memory_writes += other.memory_writes;
+	bits_read += other.bits_read;
+	bits_printed += other.bits_printed;
+	peak_memory_cells = max(peak_memory_cells, other.peak_memory_cells);
+	parse_seconds += other.parse_seconds;
+	run_seconds += other.run_seconds;
+}
+
+
+template<class Number>
+static void write_metric(ostream& out, const string& name, const char* type, const char* help, Number value)
+{
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " " << type << "\n";
+	out << name << " " << value << "\n";
+}
+
+
+void BitMetrics::write_prometheus(ostream& out, const string& prefix) const
+{
+	write_metric(out, prefix + "parses_total", "counter", "Programs parsed and compiled.", parses);
+	write_metric(out, prefix + "runs_total", "counter", "Programs run.", runs);
+	write_metric(out, prefix + "failed_runs_total", "counter", "Runs that ended with a runtime error or on a limit.", failed_runs);
+	write_metric(out, prefix + "lines_total", "counter", "Lines run.", lines);
+	write_metric(out, prefix + "nands_total", "counter", "NANDs evaluated.", nands);
+	write_metric(out, prefix + "memory_reads_total", "counter", "Reads of variables and the jump register.", memory_reads);
+	write_metric(out, prefix + "memory_writes_total", "counter", "Writes of variables and the jump register.", memory_writes);
+	write_metric(out, prefix + "bits_read_total", "counter", "Bits read from the input.", bits_read);
+	write_metric(out, prefix + "bits_printed_total", "counter", "Bits printed.", bits_printed);
+	write_metric(out, prefix + "peak_memory_cells", "gauge", "Memory cells allocated by the largest run.", peak_memory_cells);
+	write_metric(out, prefix + "parse_seconds_total", "counter", "Time spent parsing and compiling.", parse_seconds);
+	write_metric(out, prefix + "run_seconds_total", "counter", "Time spent running programs.", run_seconds);
+}
+
+
+vector<BitMetrics::Work> BitMetrics::weigh(const BytecodeProgram& program)
+{
+	vector<int> starts = program.line_starts;
+	sort(starts.begin(), starts.end());
+	vector<Work> work(program.line_starts.size(), Work{ 0, 0, 0, 0 });
+	for (size_t index = 0; index < program.line_starts.size(); index++) {
+		int start = program.line_starts[index];
+		auto next = upper_bound(starts.begin(), starts.end(), start);
+		int end = next != starts.end() ? *next : (int)program.code.size();
+		Work& line = work[index];
+		for (int pc = start; pc < end; pc++) {
+			const Instruction& instruction = program.code[pc];
+			switch (instruction.op) {
+			case OP_NAND:
+			case OP_NOT:
+				line.nands += 1;
+				break;
+			case OP_AND:
+				line.nands += 2;
+				break;
+			case OP_OR:
+				line.nands += 3;
+				break;
+			case OP_XOR:
+				line.nands += 4;
+				break;
+			case OP_LOAD_VAR:
+			case OP_LOAD_IND:
+			case OP_BEYOND:
+			case OP_JMP_IND:
+				line.memory_reads += 1;
+				break;
+			case OP_STORE:
+			case OP_STORE_IND:
+			case OP_STORE_BIT:
+				line.memory_writes += 1;
+				break;
+			case OP_PRINT:
+				line.io_bits += 1;
+				break;
+			case OP_PRINT_BITS:
+				line.io_bits += program.strings[instruction.operand].size();
+				break;
+			case OP_READ:
+				line.io_bits += 1;
+				line.memory_writes += 1;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return work;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BitBytecode.h"
+
+/// <summary>
+/// Counters of everything an interpreter ran, summed over its runs, for hosts that watch the load of their
+/// programs. The runs, the times, the bits read and printed and the peak memory are always counted.
+/// The lines, NANDs and memory accesses of programs compiled with count_work are counted by tallying every
+/// line at its start and weighing the tallies with the work of the line's bytecode when the run ends,
+/// which costs one increment per line. Without count_work only the lines of runs with limits are counted.
+/// </summary>
+struct BitMetrics {
+	/// <summary>
+	/// The work of one run of a line, read off its bytecode. A line is straight code up to its goto, so
+	/// every run does the same work.
+	/// </summary>
+	struct Work {
+		// The fused operations count the NANDs they stand for.
+		uint64_t nands;
+		// The jump register counts as a variable.
+		uint64_t memory_reads;
+		uint64_t memory_writes;
+		uint64_t io_bits;
+	};
+
+	uint64_t parses = 0;
+	uint64_t runs = 0;
+	// Runs that ended with a runtime error or on a limit.
+	uint64_t failed_runs = 0;
+	uint64_t lines = 0;
+	uint64_t nands = 0;
+	uint64_t memory_reads = 0;
+	uint64_t memory_writes = 0;
+	uint64_t bits_read = 0;
+	uint64_t bits_printed = 0;
+	// The cells of the memory pages of the largest run, memory is only released when the next run starts.
+	uint64_t peak_memory_cells = 0;
+	// Parsing includes compiling the program for its interpreter.
+	double parse_seconds = 0;
+	double run_seconds = 0;
+
+	void add(const BitMetrics& other);
+	// Writes the counters in the Prometheus text format, every name starts with the prefix.
+	void write_prometheus(std::ostream& out, const std::string& prefix = "bit_") const;
+
+	// The work of every line of the program, indexed like CodeNode::table.
+	static std::vector<Work> weigh(const BytecodeProgram& program);
+};
@@ -0,0 +1,765 @@
+#include "BitNodes.h"
+#include <string>
+#include <algorithm>
+#include <unordered_set>
+#include "BitInterpreter.h"
+#include "BitProfile.h"
+
+using namespace std;
+
+#pragma region Implementations
+
+GotoNode* CodeNode::link(int& missing_line_number) {
+	table.clear();
+	line_index.clear();
+	table.reserve(lines.size());
+	line_index.reserve(lines.size());
+	for (auto& entry : lines) {
+		LineNode* line = &entry.second;
+		line->index = (int)table.size();
+		table.push_back(line);
+		line_index[line->line_number] = line;
+	}
+	for (LineNode* line : table) {
+		GotoNode* go = line->go;
+		if (go == NULL || go->is_variable()) {
+			continue;
+		}
+		// -1 marks a missing target, a goto without a target ends the program.
+		int targets[] = { go->next, go->next_if_zero, go->next_if_one };
+		LineNode** resolved[] = { &go->target, &go->target_if_zero, &go->target_if_one };
+		for (int i = 0; i < 3; i++) {
+			if (targets[i] < 0) {
+				continue;
+			}
+			*resolved[i] = find_line(targets[i]);
+			if (*resolved[i] == NULL) {
+				missing_line_number = targets[i];
+				return go;
+			}
+		}
+	}
+	first_line = find_line(first_line_number);
+	return NULL;
+}
+
+LineNode* CodeNode::find_line(int line_number) {
+	auto it = line_index.find(line_number);
+	return it != line_index.end() ? it->second : NULL;
+}
+
+void CodeNode::run(BitInterpreter& interpreter) {
+	if (interpreter.profile != NULL) {
+		run_lines<true>(interpreter, interpreter.profile);
+	}
+	else {
+		run_lines<false>(interpreter, NULL);
+	}
+}
+
+template<bool Profiled>
+void CodeNode::run_lines(BitInterpreter& interpreter, BitProfile* profile) {
+	LineNode* line = first_line;
+	while (line != NULL) {
+		if (Profiled) {
+			profile->lines[line->index].runs++;
+		}
+		if (interpreter.options.cycle_mode != CYCLES_IGNORED) {
+			interpreter.check_cycle(line->line_number);
+		}
+		if (interpreter.options.has_limits()) {
+			interpreter.step();
+		}
+#ifdef BIT_TRACING
+		if (interpreter.trace != NULL) {
+			interpreter.trace->line(line->index, interpreter.registers.jump_register);
+		}
+#endif
+		if (interpreter.registers.tallies != NULL) {
+			interpreter.registers.tallies[line->index]++;
+		}
+		line->instruction->run(interpreter);
+		GotoNode* go = line->go;
+		if (go == NULL) {
+			if (Profiled) {
+				profile->lines[line->index].ended++;
+			}
+			break;
+		}
+		if (go->is_variable()) {
+			int next_line_number = go->next_line_number(interpreter);
+			LineNode* next = find_line(next_line_number);
+			if (next == NULL) {
+				BitInterpreter::fail("No line exists with number " + to_string(next_line_number) + ".");
+			}
+			if (Profiled) {
+				profile->lines[line->index].jumps++;
+				profile->jump(line->index, next->index);
+			}
+			line = next;
+		}
+		else {
+			LineNode* next = go->next_line(interpreter.registers.jump_register);
+			if (Profiled) {
+				BitProfile::LineCounts& counts = profile->lines[line->index];
+				if (next == NULL) {
+					counts.ended++;
+				}
+				else if (go->target != NULL) {
+					counts.jumps++;
+				}
+				else if (interpreter.registers.jump_register == 0) {
+					counts.zero++;
+				}
+				else {
+					counts.one++;
+				}
+			}
+			line = next;
+		}
+	}
+}
+
+void CommandNode::run(BitInterpreter& interpreter) {
+	if (print_value == 0 || print_value == 1) {
+		interpreter.print_bit(print_value);
+	}
+	else {
+		interpreter.memory_write(jump_register_address, Value::make(interpreter.read_bit(), BIT));
+	}
+}
+
+void AssignmentNode::run(BitInterpreter& interpreter) {
+	if (typed) {
+		interpreter.store_bit(address, expression->value(interpreter));
+	}
+	else if (address >= jump_register_address) {
+		interpreter.memory_write(address, expression->value(interpreter));
+	}
+	else {
+		interpreter.memory_write(address_expression->value(interpreter).payload(), expression->value(interpreter));
+	}
+}
+
+int GotoNode::next_line_number(BitInterpreter& interpreter) {
+	if (next > -1) {
+		if (variable) {
+			return interpreter.memory_read(next).payload();
+		}
+		return next;
+	}
+	int jump_register = interpreter.registers.jump_register;
+	if (next_if_zero > -1 && jump_register == 0) {
+		return next_if_zero;
+	}
+	if (next_if_one > -1 && jump_register == 1) {
+		return next_if_one;
+	}
+	return -1;
+}
+
+LineNode* GotoNode::next_line(int jump_register) {
+	if (target != NULL) {
+		return target;
+	}
+	if (jump_register == 0) {
+		return target_if_zero;
+	}
+	if (jump_register == 1) {
+		return target_if_one;
+	}
+	return NULL;
+}
+
+Value Expression1Node::value(BitInterpreter& interpreter) {
+	Value value_left = left->value(interpreter);
+	if (right != NULL) {
+		return BitInterpreter::nand(value_left, right->value(interpreter));
+	}
+	return value_left;
+}
+
+Value Expression2Node::value(BitInterpreter& interpreter) {
+	return BitInterpreter::address_of(child->value(interpreter));
+}
+
+Value Expression3Node::value(BitInterpreter& interpreter) {
+	return interpreter.value_beyond(child->value(interpreter));
+}
+
+Value Expression4Node::value(BitInterpreter& interpreter) {
+	return interpreter.value_at(child->value(interpreter));
+}
+
+Value Expression5Node::value(BitInterpreter& interpreter) {
+	return Value::make(constant, type);
+}
+
+Value VariableNode::value(BitInterpreter& interpreter) {
+	if (address >= jump_register_address) {
+		return interpreter.load_variable(address);
+	}
+	BitInterpreter::fail("Illegal address: " + to_string(address) + ".");
+}
+
+Value FusedNode::value(BitInterpreter& interpreter) {
+	Value value_left = left->value(interpreter);
+	switch (op) {
+	case OP_NOT:
+		return BitInterpreter::fused_not(value_left);
+	case OP_AND:
+		return BitInterpreter::fused_and(value_left, right->value(interpreter));
+	case OP_OR:
+		return BitInterpreter::fused_or(value_left, right->value(interpreter));
+	default:
+		return BitInterpreter::fused_xor(value_left, right->value(interpreter));
+	}
+}
+
+#pragma endregion
+
+#pragma region Optimizer
+
+// The optimizer rewrites the expressions of every line after linking:
+// - Expression1Nodes without NAND are dropped, they only wrap their operand.
+// - NAND and the fused operations of constants are folded if they can't fail.
+// - X NAND X becomes NOT X, so X is evaluated once, and NOT (A NAND B) becomes A AND B.
+// - (NOT A) NAND (NOT B) becomes A OR B and the two common NAND forms of exclusive or become
+//   A XOR B, but only for variables and constants. The fused operation evaluates both operands
+//   before any check, which only keeps the order of runtime errors if the operands can't fail.
+
+// Mirrors the checks of nand(), false if evaluating it would raise a runtime error.
+static bool fold_nand(Value left, Value right, Value& result) {
+	if (!left.is_bit() || !right.is_bit()) {
+		return false;
+	}
+	result = BitInterpreter::nand(left, right);
+	return true;
+}
+
+static bool fold(Op op, Value left, Value right, Value& result) {
+	Value first, second, third;
+	switch (op) {
+	case OP_NAND:
+		return fold_nand(left, right, result);
+	case OP_NOT:
+		return fold_nand(left, left, result);
+	case OP_AND:
+		return fold_nand(left, right, first) && fold_nand(first, first, result);
+	case OP_OR:
+		return fold_nand(left, left, first) && fold_nand(right, right, second) && fold_nand(first, second, result);
+	case OP_XOR:
+		return fold_nand(left, right, first) && fold_nand(left, first, second) && fold_nand(right, first, third)
+			&& fold_nand(second, third, result);
+	default:
+		return false;
+	}
+}
+
+static Expression5Node* as_constant(ExpressionNode* node) {
+	return dynamic_cast<Expression5Node*>(node);
+}
+
+static Value constant_value(Expression5Node* node) {
+	return Value::make(node->constant, node->type);
+}
+
+// A NAND of two operands, Expression1Nodes without NAND are removed before.
+static Expression1Node* as_nand(ExpressionNode* node) {
+	return dynamic_cast<Expression1Node*>(node);
+}
+
+static FusedNode* as_fused(ExpressionNode* node, Op op) {
+	FusedNode* fused = dynamic_cast<FusedNode*>(node);
+	return (fused != NULL && fused->op == op) ? fused : NULL;
+}
+
+// Variables and constants are read without any check that could fail.
+static bool is_leaf(ExpressionNode* node) {
+	return as_constant(node) != NULL || dynamic_cast<VariableNode*>(node) != NULL;
+}
+
+static ExpressionNode* make_constant(BitArena& arena, Value value) {
+	Expression5Node* node = arena.create<Expression5Node>();
+	node->constant = value.payload();
+	node->type = value.type();
+	return node;
+}
+
+static ExpressionNode* make_fused(BitArena& arena, Op op, ExpressionNode* left, ExpressionNode* right) {
+	Expression5Node* constant_left = as_constant(left);
+	Expression5Node* constant_right = right != NULL ? as_constant(right) : constant_left;
+	Value result;
+	if (constant_left != NULL && constant_right != NULL && fold(op, constant_value(constant_left), constant_value(constant_right), result)) {
+		return make_constant(arena, result);
+	}
+	FusedNode* node = arena.create<FusedNode>();
+	node->op = op;
+	node->left = left;
+	node->right = right;
+	return node;
+}
+
+// True if node is operand NAND other or other NAND operand, other is returned.
+static ExpressionNode* nand_partner(Expression1Node* node, ExpressionNode* operand) {
+	if (node->left->equals(operand)) {
+		return node->right;
+	}
+	if (node->right->equals(operand)) {
+		return node->left;
+	}
+	return NULL;
+}
+
+// (A NAND (A NAND B)) NAND (B NAND (A NAND B)) in any operand order.
+static bool match_xor(Expression1Node* left, Expression1Node* right, ExpressionNode*& a, ExpressionNode*& b) {
+	for (int i = 0; i < 2; i++) {
+		Expression1Node* shared = as_nand(i == 0 ? left->right : left->left);
+		a = i == 0 ? left->left : left->right;
+		if (shared == NULL || nand_partner(right, shared) == NULL) {
+			continue;
+		}
+		b = nand_partner(right, shared);
+		ExpressionNode* partner = nand_partner(shared, a);
+		if (partner != NULL && partner->equals(b)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// (A NAND NOT B) NAND (NOT A NAND B) in any operand order.
+static bool match_xor_not(Expression1Node* left, Expression1Node* right, ExpressionNode*& a, ExpressionNode*& b) {
+	for (int i = 0; i < 2; i++) {
+		FusedNode* not_b = as_fused(i == 0 ? left->right : left->left, OP_NOT);
+		a = i == 0 ? left->left : left->right;
+		if (not_b == NULL) {
+			continue;
+		}
+		b = not_b->left;
+		for (int j = 0; j < 2; j++) {
+			FusedNode* not_a = as_fused(j == 0 ? right->left : right->right, OP_NOT);
+			if (not_a != NULL && not_a->left->equals(a) && (j == 0 ? right->right : right->left)->equals(b)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void CodeNode::optimize() {
+	for (LineNode* line : table) {
+		line->instruction->optimize(arena);
+	}
+}
+
+void AssignmentNode::optimize(BitArena& arena) {
+	if (address_expression != NULL) {
+		address_expression = address_expression->optimize(arena);
+	}
+	expression = expression->optimize(arena);
+}
+
+ExpressionNode* Expression1Node::optimize(BitArena& arena) {
+	left = left->optimize(arena);
+	if (right == NULL) {
+		return left;
+	}
+	right = right->optimize(arena);
+	Expression5Node* constant_left = as_constant(left);
+	Expression5Node* constant_right = as_constant(right);
+	Value result;
+	if (constant_left != NULL && constant_right != NULL && fold(OP_NAND, constant_value(constant_left), constant_value(constant_right), result)) {
+		return make_constant(arena, result);
+	}
+	if (left->equals(right)) {
+		Expression1Node* inner = as_nand(left);
+		if (inner != NULL) {
+			return make_fused(arena, OP_AND, inner->left, inner->right);
+		}
+		return make_fused(arena, OP_NOT, left, NULL);
+	}
+	FusedNode* not_left = as_fused(left, OP_NOT);
+	FusedNode* not_right = as_fused(right, OP_NOT);
+	if (not_left != NULL && not_right != NULL && is_leaf(not_left->left) && is_leaf(not_right->left)) {
+		return make_fused(arena, OP_OR, not_left->left, not_right->left);
+	}
+	Expression1Node* nand_left = as_nand(left);
+	Expression1Node* nand_right = as_nand(right);
+	ExpressionNode* a;
+	ExpressionNode* b;
+	if (nand_left != NULL && nand_right != NULL
+		&& (match_xor(nand_left, nand_right, a, b) || match_xor_not(nand_left, nand_right, a, b))
+		&& is_leaf(a) && is_leaf(b)) {
+		return make_fused(arena, OP_XOR, a, b);
+	}
+	return this;
+}
+
+ExpressionNode* Expression2Node::optimize(BitArena& arena) {
+	child = child->optimize(arena);
+	return this;
+}
+
+ExpressionNode* Expression3Node::optimize(BitArena& arena) {
+	child = child->optimize(arena);
+	return this;
+}
+
+ExpressionNode* Expression4Node::optimize(BitArena& arena) {
+	child = child->optimize(arena);
+	return this;
+}
+
+bool Expression1Node::equals(ExpressionNode* other) {
+	Expression1Node* node = dynamic_cast<Expression1Node*>(other);
+	if (node == NULL || !left->equals(node->left)) {
+		return false;
+	}
+	return (right == NULL) ? node->right == NULL : (node->right != NULL && right->equals(node->right));
+}
+
+bool Expression2Node::equals(ExpressionNode* other) {
+	Expression2Node* node = dynamic_cast<Expression2Node*>(other);
+	return node != NULL && child->equals(node->child);
+}
+
+bool Expression3Node::equals(ExpressionNode* other) {
+	Expression3Node* node = dynamic_cast<Expression3Node*>(other);
+	return node != NULL && child->equals(node->child);
+}
+
+bool Expression4Node::equals(ExpressionNode* other) {
+	Expression4Node* node = dynamic_cast<Expression4Node*>(other);
+	return node != NULL && child->equals(node->child);
+}
+
+bool Expression5Node::equals(ExpressionNode* other) {
+	Expression5Node* node = as_constant(other);
+	return node != NULL && node->constant == constant && node->type == type;
+}
+
+bool VariableNode::equals(ExpressionNode* other) {
+	VariableNode* node = dynamic_cast<VariableNode*>(other);
+	return node != NULL && node->address == address;
+}
+
+bool FusedNode::equals(ExpressionNode* other) {
+	FusedNode* node = as_fused(other, op);
+	if (node == NULL || !left->equals(node->left)) {
+		return false;
+	}
+	return (right == NULL) ? node->right == NULL : right->equals(node->right);
+}
+
+#pragma endregion
+
+#pragma region Type inference
+
+// A store needs the checks of memory_write() only for values that may not be bits: addresses, constants
+// other than zero and one, and the values behind pointers. Everything else always is a bit: NAND and the
+// fused operations make bits or fail, and a variable holds bits if every store to it does.
+// The variables that may hold other values are found by iterating until no store adds one. An indirect
+// store can write any variable, then no variable is known to hold bits.
+// The inference assumes that a run starts with cleared memory. A run from a snapshot may find any value
+// in a variable the program only stores bits into. A typed store of such a value into another variable is
+// what memory_write() would do as well, so only the jump register keeps its check for addresses, in
+// BitInterpreter::store_bit() and the native code of OP_STORE_BIT. Programs that always start from kept
+// memory are inferred without cleared memory, then only stores of constants and NANDs are typed.
+
+// The addresses of the variables that may hold other values than bits.
+struct VariableTypes {
+	bool indirect;
+	unordered_set<int> mixed;
+
+	bool holds_bits(int address) const { return !indirect && mixed.count(address) == 0; };
+};
+
+static bool is_bit(ExpressionNode* node, const VariableTypes& types) {
+	if (Expression5Node* constant = as_constant(node)) {
+		return constant_value(constant).is_bit();
+	}
+	if (VariableNode* variable = dynamic_cast<VariableNode*>(node)) {
+		return variable->address >= jump_register_address && types.holds_bits(variable->address);
+	}
+	if (Expression1Node* nand = as_nand(node)) {
+		return nand->right != NULL || is_bit(nand->left, types);
+	}
+	return dynamic_cast<FusedNode*>(node) != NULL;
+}
+
+void CodeNode::infer_types(bool cleared_memory) {
+	vector<AssignmentNode*> assignments;
+	VariableTypes types = VariableTypes();
+	types.indirect = !cleared_memory;
+	for (LineNode* line : table) {
+		if (AssignmentNode* assignment = dynamic_cast<AssignmentNode*>(line->instruction)) {
+			assignments.push_back(assignment);
+			types.indirect |= assignment->address < jump_register_address;
+		}
+	}
+	for (bool changed = !types.indirect; changed; ) {
+		changed = false;
+		for (AssignmentNode* assignment : assignments) {
+			if (types.holds_bits(assignment->address) && !is_bit(assignment->expression, types)) {
+				types.mixed.insert(assignment->address);
+				changed = true;
+			}
+		}
+	}
+	for (AssignmentNode* assignment : assignments) {
+		assignment->typed = assignment->address >= jump_register_address && is_bit(assignment->expression, types);
+	}
+}
+
+#pragma endregion
+
+#pragma region Compiler
+
+// The line that continues the chain of a line: the target of a constant goto, or with a profile
+// the target of a conditional goto that was taken more often.
+static LineNode* chain_successor(LineNode* line, const BitProfile* profile) {
+	GotoNode* go = line->go;
+	if (go == NULL || go->target != NULL || profile == NULL) {
+		return go != NULL ? go->target : NULL;
+	}
+	const BitProfile::LineCounts& counts = profile->lines[line->index];
+	if (counts.zero == 0 && counts.one == 0) {
+		return NULL;
+	}
+	return counts.zero >= counts.one ? go->target_if_zero : go->target_if_one;
+}
+
+// Orders the lines into superblocks: starting at the first line, every chain of constant gotos
+// is followed until it reaches a line that is already placed. The remaining lines start new
+// chains in line number order. Inside a chain every line falls through to the next one,
+// except where a profile continued it after a conditional goto.
+vector<LineNode*> CodeNode::layout(const BitProfile* profile) {
+	vector<LineNode*> order;
+	vector<bool> placed(table.size(), false);
+	order.reserve(table.size());
+	for (size_t i = 0; i <= table.size(); i++) {
+		LineNode* line = (i == 0) ? first_line : table[i - 1];
+		while (line != NULL && !placed[line->index]) {
+			placed[line->index] = true;
+			order.push_back(line);
+			line = chain_successor(line, profile);
+		}
+	}
+	return order;
+}
+
+// Merges consecutive PRINTs into one OP_PRINT_BITS. A run is split where a jump can enter it,
+// so it only spans lines that fall through to each other. Jump operands are still line indexes.
+// Loop checks are only kept where a jump enters, every loop contains a jump.
+static void fuse_prints(BytecodeProgram& program) {
+	vector<bool> entered(program.code.size() + 1, false);
+	entered[program.entry] = true;
+	for (const Instruction& instruction : program.code) {
+		if (instruction.op == OP_JMP || instruction.op == OP_JZ || instruction.op == OP_JO) {
+			entered[program.line_starts[instruction.operand]] = true;
+		}
+		else if (instruction.op == OP_JMP_IND) {
+			// Any line can be the target of GOTO VARIABLE.
+			for (int start : program.line_starts) {
+				entered[start] = true;
+			}
+		}
+	}
+	vector<Instruction> code;
+	vector<int> moved(program.code.size() + 1);
+	code.reserve(program.code.size());
+	for (size_t pc = 0; pc < program.code.size(); pc++) {
+		const Instruction& instruction = program.code[pc];
+		Instruction* last = code.empty() ? NULL : &code.back();
+		if (instruction.op == OP_CYCLE && !entered[pc]) {
+			moved[pc] = (int)code.size();
+			continue;
+		}
+		if (instruction.op == OP_PRINT && !entered[pc] && last != NULL && (last->op == OP_PRINT || last->op == OP_PRINT_BITS)) {
+			if (last->op == OP_PRINT) {
+				program.strings.push_back(string(1, (char)('0' + last->operand)));
+				*last = { OP_PRINT_BITS, (int)program.strings.size() - 1 };
+			}
+			program.strings[last->operand] += (char)('0' + instruction.operand);
+			moved[pc] = (int)code.size() - 1;
+			continue;
+		}
+		moved[pc] = (int)code.size();
+		code.push_back(instruction);
+	}
+	moved[program.code.size()] = (int)code.size();
+	for (int& start : program.line_starts) {
+		start = moved[start];
+	}
+	for (auto& entry : program.line_pcs) {
+		entry.second = moved[entry.second];
+	}
+	program.entry = moved[program.entry];
+	program.code.swap(code);
+}
+
+void CodeNode::compile(BytecodeProgram& program, bool check_cycles, bool count_steps, const BitProfile* profile, bool traced, bool counted) {
+	program.code.clear();
+	program.line_starts.assign(table.size(), 0);
+	program.line_pcs.clear();
+	program.strings.clear();
+	program.handlers.clear();
+	vector<LineNode*> order = layout(profile);
+	for (size_t i = 0; i < order.size(); i++) {
+		LineNode* line = order[i];
+		program.line_starts[line->index] = (int)program.code.size();
+		program.line_pcs[line->line_number] = (int)program.code.size();
+		if (check_cycles) {
+			program.emit(OP_CYCLE, line->line_number);
+		}
+		if (count_steps) {
+			program.emit(OP_STEP);
+		}
+		if (traced) {
+			program.emit(OP_TRACE, line->index);
+		}
+		if (counted) {
+			program.emit(OP_TALLY, line->index);
+		}
+		line->instruction->compile(program);
+		if (line->go != NULL) {
+			line->go->compile(program, i + 1 < order.size() ? order[i + 1] : NULL);
+		}
+		else {
+			program.emit(OP_HALT);
+		}
+	}
+	program.entry = program.line_starts[first_line->index];
+	fuse_prints(program);
+
+	// Jump operands were emitted as line indexes, now that every line is placed they become instruction indexes.
+	// The stack is empty between lines, so the depth can be tracked in one pass.
+	int depth = 0;
+	program.max_stack_depth = 0;
+	for (Instruction& instruction : program.code) {
+		switch (instruction.op) {
+		case OP_JMP:
+		case OP_JZ:
+		case OP_JO:
+			instruction.operand = program.line_starts[instruction.operand];
+			break;
+		case OP_PUSH_CONST:
+		case OP_PUSH_BIT:
+		case OP_LOAD_VAR:
+			depth++;
+			break;
+		case OP_NAND:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_STORE:
+		case OP_STORE_BIT:
+			depth--;
+			break;
+		case OP_STORE_IND:
+			depth -= 2;
+			break;
+		default:
+			break;
+		}
+		program.max_stack_depth = max(program.max_stack_depth, depth);
+	}
+}
+
+void CommandNode::compile(BytecodeProgram& program) {
+	if (print_value == 0 || print_value == 1) {
+		program.emit(OP_PRINT, print_value);
+	}
+	else {
+		program.emit(OP_READ);
+	}
+}
+
+void AssignmentNode::compile(BytecodeProgram& program) {
+	if (address >= jump_register_address) {
+		expression->compile(program);
+		program.emit(typed ? OP_STORE_BIT : OP_STORE, address);
+	}
+	else {
+		address_expression->compile(program);
+		expression->compile(program);
+		program.emit(OP_STORE_IND);
+	}
+}
+
+void GotoNode::compile(BytecodeProgram& program, LineNode* following) {
+	if (is_variable()) {
+		program.emit(OP_JMP_IND, next);
+		return;
+	}
+	if (target != NULL) {
+		// A jump to the following line falls through.
+		if (target != following) {
+			program.emit(OP_JMP, target->index);
+		}
+		return;
+	}
+	// The jump register is a bit, so with both targets one of them can fall through.
+	if (target_if_zero != NULL && target_if_one != NULL) {
+		if (target_if_zero == following) {
+			program.emit(OP_JO, target_if_one->index);
+			return;
+		}
+		if (target_if_one == following) {
+			program.emit(OP_JZ, target_if_zero->index);
+			return;
+		}
+	}
+	if (target_if_zero != NULL) {
+		program.emit(OP_JZ, target_if_zero->index);
+	}
+	if (target_if_one != NULL) {
+		program.emit(OP_JO, target_if_one->index);
+	}
+	program.emit(OP_HALT);
+}
+
+void Expression1Node::compile(BytecodeProgram& program) {
+	left->compile(program);
+	if (right != NULL) {
+		right->compile(program);
+		program.emit(OP_NAND);
+	}
+}
+
+void Expression2Node::compile(BytecodeProgram& program) {
+	child->compile(program);
+	program.emit(OP_ADDR_OF);
+}
+
+void Expression3Node::compile(BytecodeProgram& program) {
+	child->compile(program);
+	program.emit(OP_BEYOND);
+}
+
+void Expression4Node::compile(BytecodeProgram& program) {
+	child->compile(program);
+	program.emit(OP_LOAD_IND);
+}
+
+void Expression5Node::compile(BytecodeProgram& program) {
+	program.emit(type == BIT ? OP_PUSH_BIT : OP_PUSH_CONST, constant);
+}
+
+void VariableNode::compile(BytecodeProgram& program) {
+	if (address < jump_register_address) {
+		BitInterpreter::fail("Illegal address: " + to_string(address) + ".");
+	}
+	program.emit(OP_LOAD_VAR, address);
+}
+
+void FusedNode::compile(BytecodeProgram& program) {
+	left->compile(program);
+	if (right != NULL) {
+		right->compile(program);
+	}
+	program.emit(op);
+}
+
+#pragma endregion
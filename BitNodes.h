@@ -0,0 +1,214 @@
+#pragma once
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <climits>
+#include "BitValue.h"
+#include "BitArena.h"
+#include "BitBytecode.h"
+
+class BitInterpreter;
+class BitProfile;
+class LineNode;
+class InstructionNode;
+class CommandNode;
+class AssignmentNode;
+class GotoNode;
+class ExpressionNode;
+class Expression1Node;
+class Expression2Node;
+class Expression3Node;
+class Expression4Node;
+class Expression5Node;
+class VariableNode;
+class FusedNode;
+
+/// <summary>
+/// The syntax tree of a BIT program, one node class per grammar rule of BitParser.h.
+/// The tree walking interpreter evaluates the nodes directly, the compiler lowers them to bytecode.
+/// </summary>
+class Node {
+};
+
+// The nodes below a CodeNode are allocated from its arena and released with it.
+class CodeNode : public Node {
+public:
+	BitArena arena;
+	std::map<int, LineNode> lines;
+	int first_line_number;
+	// Filled by link(): the lines in line number order and a hash lookup for GOTO VARIABLE.
+	std::vector<LineNode*> table;
+	std::unordered_map<int, LineNode*> line_index;
+	LineNode* first_line;
+
+	CodeNode() : first_line_number(-1), first_line(NULL) {};
+	// Resolves the gotos, returns the first one whose line doesn't exist or NULL.
+	GotoNode* link(int& missing_line_number);
+	void optimize();
+	// Marks the stores that are proven to be well typed, see AssignmentNode::typed. Without cleared memory
+	// every variable may hold any value when the run starts.
+	void infer_types(bool cleared_memory = true);
+	// With a profile, chains also continue into the more frequent target of a conditional goto.
+	std::vector<LineNode*> layout(const BitProfile* profile = NULL);
+	LineNode* find_line(int line_number);
+	// Traced programs record every line with OP_TRACE, counted programs tally every line with OP_TALLY.
+	void compile(BytecodeProgram& program, bool check_cycles, bool count_steps, const BitProfile* profile = NULL, bool traced = false, bool counted = false);
+	void run(BitInterpreter& interpreter);
+	// The run loop with and without counting into the profile of the interpreter.
+	template<bool Profiled> void run_lines(BitInterpreter& interpreter, BitProfile* profile);
+};
+
+class LineNode : public Node {
+public:
+	int line_number;
+	int index;
+	InstructionNode* instruction;
+	GotoNode* go;
+	// The offset of LINE NUMBER in the source, -1 for lines of compiled files.
+	int position;
+
+	LineNode() : line_number(-1), index(-1), instruction(NULL), go(NULL), position(-1) {};
+	LineNode(const LineNode&) = delete;
+	LineNode& operator=(const LineNode&) = delete;
+};
+
+class InstructionNode : public Node {
+public:
+	virtual void run(BitInterpreter& interpreter) = 0;
+	virtual void compile(BytecodeProgram& program) = 0;
+	virtual void optimize(BitArena& arena) {};
+};
+
+class CommandNode : public InstructionNode {
+public:
+	int print_value;
+
+	CommandNode() : print_value(-1) {};
+	void run(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+};
+
+class AssignmentNode : public InstructionNode {
+public:
+	int address;
+	ExpressionNode* address_expression;
+	ExpressionNode* expression;
+	// Set by CodeNode::infer_types() if the address is the jump register or a variable and the expression
+	// always is a bit, the store then runs without the checks of BitInterpreter::memory_write().
+	bool typed;
+
+	AssignmentNode() : address(INT_MIN), address_expression(NULL), expression(NULL), typed(false) {};
+	void run(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	void optimize(BitArena& arena);
+};
+
+class GotoNode : public Node {
+public:
+	// The line number of an unconditional goto, with variable the address that holds it. -1 otherwise.
+	int next;
+	bool variable;
+	int next_if_zero;
+	int next_if_one;
+	// Successors resolved by CodeNode::link(). NULL means the program ends there.
+	LineNode* target;
+	LineNode* target_if_zero;
+	LineNode* target_if_one;
+	int position;
+
+	GotoNode() : next(-1), variable(false), next_if_zero(-1), next_if_one(-1), target(NULL), target_if_zero(NULL), target_if_one(NULL), position(0) {};
+	bool is_variable() { return variable && next > -1; };
+	int next_line_number(BitInterpreter& interpreter);
+	LineNode* next_line(int jump_register);
+	void compile(BytecodeProgram& program, LineNode* following);
+};
+
+class ExpressionNode : public Node {
+public:
+	virtual Value value(BitInterpreter& interpreter) = 0;
+	virtual void compile(BytecodeProgram& program) = 0;
+	// Returns the node that replaces this one after its children were optimized.
+	virtual ExpressionNode* optimize(BitArena& arena) { return this; };
+	// True if both expressions are the same tree and always evaluate to the same value.
+	virtual bool equals(ExpressionNode* other) = 0;
+};
+
+class Expression1Node : public ExpressionNode {
+public:
+	ExpressionNode* left;
+	ExpressionNode* right;
+
+	Expression1Node() : left(NULL), right(NULL) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	ExpressionNode* optimize(BitArena& arena);
+	bool equals(ExpressionNode* other);
+};
+
+class Expression2Node : public ExpressionNode {
+public:
+	ExpressionNode* child;
+
+	Expression2Node() : child(NULL) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	ExpressionNode* optimize(BitArena& arena);
+	bool equals(ExpressionNode* other);
+};
+
+class Expression3Node : public ExpressionNode {
+public:
+	ExpressionNode* child;
+
+	Expression3Node() : child(NULL) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	ExpressionNode* optimize(BitArena& arena);
+	bool equals(ExpressionNode* other);
+};
+
+class Expression4Node : public ExpressionNode {
+public:
+	ExpressionNode* child;
+
+	Expression4Node() : child(NULL) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	ExpressionNode* optimize(BitArena& arena);
+	bool equals(ExpressionNode* other);
+};
+
+class Expression5Node : public ExpressionNode {
+public:
+	int constant;
+	// Bit constants of the source are undefined, constants folded by the optimizer are bits.
+	ValueType type;
+
+	Expression5Node() : constant(0), type(UNDEFINED) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	bool equals(ExpressionNode* other);
+};
+
+class VariableNode : public ExpressionNode {
+public:
+	int address;
+
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	bool equals(ExpressionNode* other);
+};
+
+// A NAND idiom recognized by the optimizer, evaluated as a single operation.
+class FusedNode : public ExpressionNode {
+public:
+	Op op;
+	ExpressionNode* left;
+	// NULL for OP_NOT.
+	ExpressionNode* right;
+
+	FusedNode() : op(OP_NOT), left(NULL), right(NULL) {};
+	Value value(BitInterpreter& interpreter);
+	void compile(BytecodeProgram& program);
+	bool equals(ExpressionNode* other);
+};
@@ -0,0 +1,281 @@
+#include "BitParser.h"
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <ctype.h>
+#include "BitError.h"
+
+using namespace std;
+
+BitParser::BitParser(BitReader& source) : source(&source), lexer(NULL), arena(NULL), position(0) {
+	token = { TOKEN_END, 0, 0, 0 };
+}
+
+bool BitParser::at_end() {
+	return source->at_end();
+}
+
+void BitParser::fail(const string& message) {
+	const int preview_length = 60;
+	int from = max(position - preview_length / 2, 0);
+	string preview = source->excerpt(from, position + preview_length / 2);
+	replace_if(preview.begin(), preview.end(), [](char character) { return isspace((unsigned char)character) != 0; }, ' ');
+	// The reader may have dropped the start of a long token, the caret then points to the start of the preview.
+	throw BitParserError(message, position, preview, max(position - from, 0));
+}
+
+void BitParser::fail_at(int position, const string& message) {
+	this->position = position;
+	fail(message);
+}
+
+void BitParser::next_token() {
+	token = lexer->next();
+	position = token.offset;
+}
+
+bool BitParser::check(TokenType type) {
+	return token.type == type;
+}
+
+void BitParser::consume(TokenType type) {
+	if (token.type != type) {
+		fail("Illegal symbol found. " + string(BitLexer::spelling(type)) + " was expected.");
+	}
+	next_token();
+}
+
+
+CodeNode* BitParser::parse(bool optimize) {
+	BitLexer tokens(*source);
+	lexer = &tokens;
+	next_token();
+	unique_ptr<CodeNode> code(new CodeNode());
+	parse_code(code.get());
+	// The delimiter is the last character of the program, the source is not read any further.
+	if (!check(TOKEN_DELIMITER) && !check(TOKEN_END)) {
+		fail("Illegal symbol found. LINENUMBER or ; was expected.");
+	}
+	int missing_line_number;
+	GotoNode* unresolved = code->link(missing_line_number);
+	if (unresolved != NULL) {
+		position = unresolved->position;
+		fail("No line exists with number " + to_string(missing_line_number));
+	}
+	if (optimize) {
+		code->optimize();
+	}
+	lexer = NULL;
+	arena = NULL;
+	return code.release();
+}
+
+LineNode* BitParser::parse_record(BitArena& arena, map<int, LineNode>& lines) {
+	BitLexer tokens(*source);
+	lexer = &tokens;
+	this->arena = &arena;
+	next_token();
+	LineNode* line = parse_line(lines);
+	if (!check(TOKEN_LINE_NUMBER) && !check(TOKEN_DELIMITER) && !check(TOKEN_END)) {
+		fail("Illegal symbol found. LINENUMBER or ; was expected.");
+	}
+	lexer = NULL;
+	this->arena = NULL;
+	return line;
+}
+
+void BitParser::parse_code(CodeNode* node) {
+	arena = &node->arena;
+	LineNode* line = parse_line(node->lines);
+	node->first_line_number = line->line_number;
+	while (check(TOKEN_LINE_NUMBER)) {
+		parse_line(node->lines);
+	}
+}
+
+// The line is parsed in place into the lines of the code.
+LineNode* BitParser::parse_line(map<int, LineNode>& lines) {
+	int start = position;
+	consume(TOKEN_LINE_NUMBER);
+	int line_number = parse_bits();
+	auto entry = lines.try_emplace(line_number);
+	bool defined = !entry.second;
+	LineNode* node = &entry.first->second;
+	node->line_number = line_number;
+	node->position = start;
+	consume(TOKEN_CODE);
+	node->instruction = parse_instruction();
+	node->go = check(TOKEN_GOTO) ? parse_goto() : NULL;
+	if (defined) {
+		fail("Line number is " + to_string(line_number) + " already defined.");
+	}
+	return node;
+}
+
+InstructionNode* BitParser::parse_instruction() {
+	if (check(TOKEN_PRINT) || check(TOKEN_READ)) {
+		return parse_command();
+	}
+	return parse_assignment();
+}
+
+InstructionNode* BitParser::parse_command() {
+	CommandNode* node = arena->create<CommandNode>();
+	if (check(TOKEN_PRINT)) {
+		consume(TOKEN_PRINT);
+		node->print_value = parse_bit();
+		return node;
+	}
+	if (check(TOKEN_READ)) {
+		consume(TOKEN_READ);
+		return node;
+	}
+	fail("Illegal symbol found. Command was expected.");
+}
+
+InstructionNode* BitParser::parse_assignment() {
+	AssignmentNode* node = arena->create<AssignmentNode>();
+	if (check(TOKEN_VARIABLE) || check(TOKEN_THE_JUMP_REGISTER)) {
+		node->address = parse_variable()->address;
+	}
+	else {
+		node->address_expression = parse_expression();
+	}
+	consume(TOKEN_EQUALS);
+	node->expression = parse_expression();
+	return node;
+}
+
+GotoNode* BitParser::parse_goto() {
+	GotoNode* node = arena->create<GotoNode>();
+	node->position = position;
+	consume(TOKEN_GOTO);
+	if (check(TOKEN_VARIABLE)) {
+		consume(TOKEN_VARIABLE);
+		node->variable = true;
+	}
+	int address1 = parse_bits();
+	if (check(TOKEN_IF_THE_JUMP_REGISTER_IS)) {
+		consume(TOKEN_IF_THE_JUMP_REGISTER_IS);
+		if (check(TOKEN_EQUAL_TO)) {
+			consume(TOKEN_EQUAL_TO);
+		}
+		int bit1 = parse_bit();
+		(bit1 == 0) ? (node->next_if_zero = address1) : (node->next_if_one = address1);
+		if (check(TOKEN_GOTO)) {
+			consume(TOKEN_GOTO);
+			int address2 = parse_bits();
+			consume(TOKEN_IF_THE_JUMP_REGISTER_IS);
+			if (check(TOKEN_EQUAL_TO)) {
+				consume(TOKEN_EQUAL_TO);
+			}
+			int bit2 = parse_bit();
+			if (bit1 == bit2) {
+				fail("Illegal symbol found. Conditional goto with different bit constant was expected.");
+			}
+			(bit2 == 0) ? (node->next_if_zero = address2) : (node->next_if_one = address2);
+		}
+		return node;
+	}
+	node->next = address1;
+	return node;
+}
+
+ExpressionNode* BitParser::parse_expression() {
+	Expression1Node* node = arena->create<Expression1Node>();
+	node->left = parse_expression2();
+	if (check(TOKEN_NAND)) {
+		consume(TOKEN_NAND);
+		node->right = parse_expression2();
+	}
+	return node;
+}
+
+ExpressionNode* BitParser::parse_expression2() {
+	if (check(TOKEN_THE_ADDRESS_OF)) {
+		consume(TOKEN_THE_ADDRESS_OF);
+		Expression2Node* node = arena->create<Expression2Node>();
+		node->child = parse_expression3();
+		return node;
+	}
+	return parse_expression3();
+}
+
+ExpressionNode* BitParser::parse_expression3() {
+	if (check(TOKEN_THE_VALUE_BEYOND)) {
+		consume(TOKEN_THE_VALUE_BEYOND);
+		Expression3Node* node = arena->create<Expression3Node>();
+		node->child = parse_expression4();
+		return node;
+	}
+	return parse_expression4();
+}
+
+ExpressionNode* BitParser::parse_expression4() {
+	if (check(TOKEN_THE_VALUE_AT)) {
+		consume(TOKEN_THE_VALUE_AT);
+		Expression4Node* node = arena->create<Expression4Node>();
+		node->child = parse_expression5();
+		return node;
+	}
+	return parse_expression5();
+}
+
+ExpressionNode* BitParser::parse_expression5() {
+	if (check(TOKEN_VARIABLE) || check(TOKEN_THE_JUMP_REGISTER)) {
+		return parse_variable();
+	}
+	if (check(TOKEN_BITS)) {
+		Expression5Node* node = arena->create<Expression5Node>();
+		node->constant = parse_bits();
+		return node;
+	}
+	if (check(TOKEN_OPEN_PARENTHESIS)) {
+		consume(TOKEN_OPEN_PARENTHESIS);
+		ExpressionNode* node = parse_expression();
+		consume(TOKEN_CLOSE_PARENTHESIS);
+		return node;
+	}
+	fail("Illegal symbol found. Expression was expected.");
+}
+
+// TODO: hier muss ein Value zurckgegeben werden, nicht ein node
+// TODO: vielleicht den expression node um die funktion address() erweitern, damit auch die adresse falls ntig zur runtime ausgewertet werden kann
+VariableNode* BitParser::parse_variable() {
+	if (check(TOKEN_VARIABLE)) {
+		consume(TOKEN_VARIABLE);
+		VariableNode* node = arena->create<VariableNode>();
+		node->address = parse_bits();
+		return node;
+	}
+	if (check(TOKEN_THE_JUMP_REGISTER)) {
+		consume(TOKEN_THE_JUMP_REGISTER);
+		VariableNode* node = arena->create<VariableNode>();
+		node->address = jump_register_address;
+		return node;
+	}
+	fail("Illegal symbol found. Variable was expected.");
+}
+
+// Constants, line numbers and addresses all have to fit into the payload of a value, the line number of a
+// GOTO VARIABLE and the address of an ADDRESS OF are values.
+int BitParser::parse_bits() {
+	if (!check(TOKEN_BITS)) {
+		fail("Illegal symbol found. Bit constant was expected.");
+	}
+	if (token.value > Value::max_payload) {
+		fail("Bit constant is too large, the largest is " + to_string(Value::max_payload) + ".");
+	}
+	int bits = token.value;
+	next_token();
+	return bits;
+}
+
+int BitParser::parse_bit() {
+	if (!check(TOKEN_BITS) || token.bit_count != 1) {
+		fail("Illegal symbol found. Bit constant was expected.");
+	}
+	int bit = token.value;
+	next_token();
+	return bit;
+}
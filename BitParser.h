@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include "BitNodes.h"
+#include "BitReader.h"
+#include "BitLexer.h"
+
+/// <summary>
+/// The parser of the esotheric programming language "BIT".
+/// http://www.dangermouse.net/esoteric/bit.html
+/// This is the languages grammar:
+/// <![CDATA[
+///
+/// <source>       ::= <code> [ ";" <code> ]... [ ";" ]
+/// <code>         ::= <line> [ <line> ]...
+/// <line>         ::= "LINE NUMBER" <bits> "CODE" <instruction> [ <goto> ]
+/// <instruction>  ::= <command>
+///                  | <assignment>
+/// <goto>         ::= "GOTO" [ "VARIABLE" ] <bits> [ "IF THE JUMP REGISTER IS" [ "EQUAL TO" ] <bit>
+///                  [ "GOTO" [ "VARIABLE" ] <bits> "IF THE JUMP REGISTER IS" [ "EQUAL TO" ] <bit> ] ]
+///
+/// <command>      ::= "PRINT" <bit>
+///                  | "READ"
+/// <assignment>   ::= (<variable> | <expression>) "EQUALS" <expression>
+///
+/// <expression>   ::= <expression2> [ "NAND" <expression2> ]
+/// <expression2>  ::= [ "THE ADDRESS OF" ] <expression3>
+/// <expression3>  ::= [ "THE VALUE BEYOND" ] <expression4>
+/// <expression4>  ::= [ "THE VALUE AT" ] <expression5>
+/// <expression5>  ::= <variable>
+///                  | <bits>
+///                  | "OPEN PARENTHESIS" <expression> "CLOSE PARENTHESIS"
+///
+/// <variable>     ::= "VARIABLE" <bits>
+///                  | "THE JUMP REGISTER"
+///
+/// <bits>         ::= <bit> [ <bit> ]...
+/// <bit>          ::= "ZERO"
+///                  | "ONE"
+///
+/// ]]>
+/// Syntax errors are thrown as BitParserError.
+/// </summary>
+class BitParser
+{
+public:
+	BitParser(BitReader& source);
+	BitParser(const BitParser&) = delete;
+	BitParser& operator=(const BitParser&) = delete;
+
+	// Parses and links the next program of the source, up to its delimiter.
+	CodeNode* parse(bool optimize);
+	bool at_end();
+	// Parses the line at the current position of the source into lines, a line that exists already is an
+	// error. The line is neither linked nor optimized, BitLiveProgram patches it into a program.
+	LineNode* parse_record(BitArena& arena, std::map<int, LineNode>& lines);
+	// Throws a syntax error at a position of the source, for errors found after parsing.
+	[[noreturn]] void fail_at(int position, const std::string& message);
+
+private:
+	BitReader* source;
+	BitLexer* lexer;
+	BitArena* arena;
+	Token token;
+	int position;
+
+	[[noreturn]] void fail(const std::string& message);
+	inline void next_token();
+	inline bool check(TokenType type);
+	void consume(TokenType type);
+
+	void parse_code(CodeNode* node);
+	LineNode* parse_line(std::map<int, LineNode>& lines);
+	InstructionNode* parse_instruction();
+	InstructionNode* parse_command();
+	InstructionNode* parse_assignment();
+	GotoNode* parse_goto();
+	ExpressionNode* parse_expression();
+	ExpressionNode* parse_expression2();
+	ExpressionNode* parse_expression3();
+	ExpressionNode* parse_expression4();
+	ExpressionNode* parse_expression5();
+	VariableNode* parse_variable();
+	int parse_bits();
+	int parse_bit();
+};
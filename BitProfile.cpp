@@ -0,0 +1,156 @@
+#include "BitProfile.h"
+#include <algorithm>
+#include <iomanip>
+#include "BitNodes.h"
+
+using namespace std;
+
+// The text report shows the hottest entries of every table, the JSON report all of them.
+static const size_t text_rows = 20;
+static const char* const edge_names[] = { "goto", "zero", "one", "variable", "end" };
+static const char* const edge_labels[] = { "", " (IF ZERO)", " (IF ONE)", " (VARIABLE)", "" };
+
+
+BitProfile::BitProfile(const CodeNode& code) : lines(code.table.size(), LineCounts())
+{
+	for (const LineNode* line : code.table) {
+		const GotoNode* go = line->go;
+		line_numbers.push_back(line->line_number);
+		targets.push_back(go != NULL && go->target != NULL ? go->target->line_number : -1);
+		targets_if_zero.push_back(go != NULL && go->target_if_zero != NULL ? go->target_if_zero->line_number : -1);
+		targets_if_one.push_back(go != NULL && go->target_if_one != NULL ? go->target_if_one->line_number : -1);
+	}
+}
+
+
+uint64_t BitProfile::total_runs() const
+{
+	uint64_t runs = 0;
+	for (const LineCounts& counts : lines) {
+		runs += counts.runs;
+	}
+	return runs;
+}
+
+
+vector<size_t> BitProfile::hot_lines() const
+{
+	vector<size_t> indexes;
+	for (size_t index = 0; index < lines.size(); index++) {
+		if (lines[index].runs > 0) {
+			indexes.push_back(index);
+		}
+	}
+	stable_sort(indexes.begin(), indexes.end(), [this](size_t a, size_t b) { return lines[a].runs > lines[b].runs; });
+	return indexes;
+}
+
+
+vector<BitProfile::Edge> BitProfile::hot_edges() const
+{
+	vector<Edge> edges;
+	for (size_t index = 0; index < lines.size(); index++) {
+		const LineCounts& counts = lines[index];
+		int from = line_numbers[index];
+		if (counts.jumps > 0 && targets[index] >= 0) {
+			edges.push_back({ from, targets[index], EDGE_GOTO, counts.jumps });
+		}
+		if (counts.zero > 0) {
+			edges.push_back({ from, targets_if_zero[index], EDGE_ZERO, counts.zero });
+		}
+		if (counts.one > 0) {
+			edges.push_back({ from, targets_if_one[index], EDGE_ONE, counts.one });
+		}
+		if (counts.ended > 0) {
+			edges.push_back({ from, -1, EDGE_END, counts.ended });
+		}
+	}
+	for (const auto& entry : variable_jumps) {
+		edges.push_back({ line_numbers[entry.first >> 32], line_numbers[(uint32_t)entry.first], EDGE_VARIABLE, entry.second });
+	}
+	stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+		return a.count != b.count ? a.count > b.count : a.from != b.from ? a.from < b.from : a.to < b.to;
+	});
+	return edges;
+}
+
+
+vector<pair<int, BitProfile::MemoryCounts>> BitProfile::hot_addresses() const
+{
+	vector<pair<int, MemoryCounts>> addresses(memory.begin(), memory.end());
+	sort(addresses.begin(), addresses.end(), [](const pair<int, MemoryCounts>& a, const pair<int, MemoryCounts>& b) {
+		uint64_t a_count = a.second.reads + a.second.writes;
+		uint64_t b_count = b.second.reads + b.second.writes;
+		return a_count != b_count ? a_count > b_count : a.first < b.first;
+	});
+	return addresses;
+}
+
+
+void BitProfile::write_text(ostream& out) const
+{
+	uint64_t runs = total_runs();
+	out << "Lines run: " << runs << "\n\n";
+	out << "Hot lines\n" << setw(14) << "runs" << setw(8) << "share" << "  line\n";
+	vector<size_t> indexes = hot_lines();
+	for (size_t i = 0; i < indexes.size() && i < text_rows; i++) {
+		const LineCounts& counts = lines[indexes[i]];
+		out << setw(14) << counts.runs << setw(7) << fixed << setprecision(1) << 100.0 * counts.runs / runs << "%  "
+			<< line_numbers[indexes[i]] << "\n";
+	}
+	out << "\nHot edges\n" << setw(14) << "count" << "  from -> to\n";
+	vector<Edge> edges = hot_edges();
+	for (size_t i = 0; i < edges.size() && i < text_rows; i++) {
+		const Edge& edge = edges[i];
+		out << setw(14) << edge.count << "  " << edge.from << " -> ";
+		if (edge.to < 0) {
+			out << "end";
+		}
+		else {
+			out << edge.to;
+		}
+		out << edge_labels[edge.kind] << "\n";
+	}
+	out << "\nMemory\n" << setw(14) << "reads" << setw(14) << "writes" << "  address\n";
+	vector<pair<int, MemoryCounts>> addresses = hot_addresses();
+	for (size_t i = 0; i < addresses.size() && i < text_rows; i++) {
+		out << setw(14) << addresses[i].second.reads << setw(14) << addresses[i].second.writes << "  ";
+		if (addresses[i].first == jump_register_address) {
+			out << "jump register\n";
+		}
+		else {
+			out << addresses[i].first << "\n";
+		}
+	}
+}
+
+
+void BitProfile::write_json(ostream& out) const
+{
+	out << "{\"runs\":" << total_runs() << ",\"lines\":[";
+	vector<size_t> indexes = hot_lines();
+	for (size_t i = 0; i < indexes.size(); i++) {
+		const LineCounts& counts = lines[indexes[i]];
+		out << (i > 0 ? "," : "") << "{\"line\":" << line_numbers[indexes[i]] << ",\"runs\":" << counts.runs << "}";
+	}
+	out << "],\"edges\":[";
+	vector<Edge> edges = hot_edges();
+	for (size_t i = 0; i < edges.size(); i++) {
+		const Edge& edge = edges[i];
+		out << (i > 0 ? "," : "") << "{\"from\":" << edge.from << ",\"to\":";
+		if (edge.to < 0) {
+			out << "null";
+		}
+		else {
+			out << edge.to;
+		}
+		out << ",\"kind\":\"" << edge_names[edge.kind] << "\",\"count\":" << edge.count << "}";
+	}
+	out << "],\"memory\":[";
+	vector<pair<int, MemoryCounts>> addresses = hot_addresses();
+	for (size_t i = 0; i < addresses.size(); i++) {
+		out << (i > 0 ? "," : "") << "{\"address\":" << addresses[i].first << ",\"reads\":" << addresses[i].second.reads
+			<< ",\"writes\":" << addresses[i].second.writes << "}";
+	}
+	out << "]}";
+}
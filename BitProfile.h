@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+class CodeNode;
+
+/// <summary>
+/// Execution counts of one program, gathered by the tree walking interpreter: how often every line ran,
+/// which way every goto went and how often every memory address was read and written.
+/// The profile keeps the line numbers and goto targets it needs, so it can be reported after the
+/// program was released. The reports list the hottest lines, edges and addresses first.
+/// </summary>
+class BitProfile
+{
+public:
+	struct LineCounts {
+		uint64_t runs;
+		// Constant and variable gotos that were followed.
+		uint64_t jumps;
+		// Conditional gotos, IF ZERO and IF ONE.
+		uint64_t zero;
+		uint64_t one;
+		// The program ended after the line.
+		uint64_t ended;
+	};
+
+	struct MemoryCounts {
+		uint64_t reads;
+		uint64_t writes;
+	};
+
+	// Indexed like CodeNode::table.
+	std::vector<LineCounts> lines;
+	// The number of times GOTO VARIABLE went from a line to another one, keyed by both line indexes.
+	std::unordered_map<uint64_t, uint64_t> variable_jumps;
+	// The jump register is address -1.
+	std::unordered_map<int, MemoryCounts> memory;
+
+	BitProfile(const CodeNode& code);
+
+	inline void read(int address) {
+		memory[address].reads++;
+	}
+
+	inline void write(int address) {
+		memory[address].writes++;
+	}
+
+	inline void jump(int from, int to) {
+		variable_jumps[((uint64_t)(uint32_t)from << 32) | (uint32_t)to]++;
+	}
+
+	void write_text(std::ostream& out) const;
+	void write_json(std::ostream& out) const;
+
+private:
+	enum EdgeKind {
+		EDGE_GOTO,
+		EDGE_ZERO,
+		EDGE_ONE,
+		EDGE_VARIABLE,
+		EDGE_END
+	};
+
+	struct Edge {
+		int from;
+		// -1 is the end of the program.
+		int to;
+		EdgeKind kind;
+		uint64_t count;
+	};
+
+	std::vector<int> line_numbers;
+	// The line numbers of the goto targets of every line, -1 if there is none.
+	std::vector<int> targets;
+	std::vector<int> targets_if_zero;
+	std::vector<int> targets_if_one;
+
+	uint64_t total_runs() const;
+	std::vector<size_t> hot_lines() const;
+	std::vector<Edge> hot_edges() const;
+	std::vector<std::pair<int, MemoryCounts>> hot_addresses() const;
+};
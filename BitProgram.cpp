@@ -0,0 +1,45 @@
+#include "BitProgram.h"
+#include "BitNodes.h"
+#include "BitInterpreter.h"
+
+
+BitProgram::BitProgram(CodeNode* code, const BitOptions& options, const BitProfile* profile) : code(code)
+{
+	code->infer_types(!options.kept_memory);
+	if (!options.use_tree_walker) {
+		code->compile(bytecode, options.cycle_mode != CYCLES_IGNORED, options.has_limits() || options.speculate, profile, options.trace, options.count_work);
+		// Speculation continues the virtual machine at the instruction after a READ.
+		if (options.use_jit && !options.speculate && BitJit::is_supported()) {
+			jit.reset(new BitJit(BitInterpreter::native_runtime()));
+			if (!jit->compile(bytecode)) {
+				jit.reset();
+			}
+		}
+	}
+	if (options.count_work) {
+		if (options.use_tree_walker) {
+			BytecodeProgram lowered;
+			code->compile(lowered, false, false);
+			work = BitMetrics::weigh(lowered);
+		}
+		else {
+			work = BitMetrics::weigh(bytecode);
+		}
+	}
+	// Lanes can't be checked for endless loops, have no limits and aren't counted.
+	if (options.use_bit_slicing && options.cycle_mode == CYCLES_IGNORED && !options.has_limits() && !options.count_work) {
+		BytecodeProgram lowered;
+		if (options.use_tree_walker) {
+			code->compile(lowered, false, false);
+		}
+		sliced.reset(new BitSlicedProgram());
+		if (!sliced->compile(options.use_tree_walker ? lowered : bytecode)) {
+			sliced.reset();
+		}
+	}
+}
+
+
+BitProgram::~BitProgram()
+{
+}
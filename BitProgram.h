@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include "BitBytecode.h"
+#include "BitJit.h"
+#include "BitSliced.h"
+#include "BitMetrics.h"
+
+class CodeNode;
+class BitProfile;
+struct BitOptions;
+
+/// <summary>
+/// A parsed program prepared for the interpreters that run it: the syntax tree, its bytecode and its
+/// machine code, depending on the options. Running a program doesn't change it, so it is parsed and
+/// compiled once and any number of interpreters can run it at the same time, also from several threads.
+/// </summary>
+class BitProgram
+{
+public:
+	std::unique_ptr<CodeNode> code;
+	// Empty if the tree walker runs the program.
+	BytecodeProgram bytecode;
+	// NULL if the program runs on the virtual machine.
+	std::unique_ptr<BitJit> jit;
+	// NULL unless bit slicing is used and the program can be sliced.
+	std::unique_ptr<BitSlicedProgram> sliced;
+	// The work of every line, empty unless the options count work.
+	std::vector<BitMetrics::Work> work;
+
+	// Takes ownership of the code. A profile of an earlier run guides the layout of the bytecode.
+	BitProgram(CodeNode* code, const BitOptions& options, const BitProfile* profile = NULL);
+	~BitProgram();
+	BitProgram(const BitProgram&) = delete;
+	BitProgram& operator=(const BitProgram&) = delete;
+};
@@ -0,0 +1,106 @@
+#include "BitReader.h"
+#include <cstring>
+#include <ctype.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#define read _read
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+
+BitReader::BitReader(FILE* file, bool prefetch) : file(file), storage(buffer_size), base(0), eof(false), prefetch(prefetch)
+{
+	data = current = limit = storage.data();
+}
+
+
+BitReader::BitReader(const char* begin, const char* end) : file(NULL), data(begin), current(begin), limit(end), base(0), eof(true), prefetch(false)
+{
+}
+
+
+BitReader::~BitReader()
+{
+	if (queue != NULL) {
+		queue->close();
+	}
+}
+
+
+bool BitReader::at_end()
+{
+	skip_whitespace();
+	return peek() == EOF;
+}
+
+
+std::string BitReader::excerpt(int& from, int to) const
+{
+	from = std::max(from, base);
+	to = std::min(to, base + (int)(limit - data));
+	if (to <= from) {
+		return "";
+	}
+	return std::string(data + (from - base), to - from);
+}
+
+
+bool BitReader::fill()
+{
+	if (eof) {
+		return false;
+	}
+	char* buffer = storage.data();
+	size_t keep = std::min((size_t)(current - data), (size_t)history_size);
+	memmove(buffer, current - keep, keep);
+	base += (int)((current - keep) - data);
+	data = buffer;
+	current = buffer + keep;
+	int count;
+	if (prefetch) {
+		if (queue == NULL) {
+			start_prefetch();
+		}
+		const BitChunkQueue::Chunk* chunk = queue->begin_read();
+		count = chunk != NULL ? (int)chunk->size : 0;
+		if (chunk != NULL) {
+			memcpy(buffer + keep, chunk->data.data(), chunk->size);
+			queue->end_read();
+		}
+	}
+	else {
+		// read() returns what is available instead of waiting for a full buffer.
+		count = (int)read(fileno(file), buffer + keep, (unsigned int)(buffer_size - keep));
+	}
+	if (count <= 0) {
+		eof = true;
+		limit = current;
+		return false;
+	}
+	limit = current + count;
+	return true;
+}
+
+
+// The chunks leave room for the history in the buffer.
+void BitReader::start_prefetch()
+{
+	queue = std::make_shared<BitChunkQueue>(buffer_size - history_size);
+	std::shared_ptr<BitChunkQueue> chunks = queue;
+	int descriptor = fileno(file);
+	std::thread([chunks, descriptor]() {
+		for (BitChunkQueue::Chunk* chunk = chunks->begin_write(); chunk != NULL; chunk = chunks->begin_write()) {
+			int count = (int)read(descriptor, chunk->data.data(), (unsigned int)chunk->data.size());
+			if (count <= 0) {
+				break;
+			}
+			chunk->size = count;
+			chunks->end_write();
+		}
+		chunks->close();
+	}).detach();
+}
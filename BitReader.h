@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdio>
+#include <ctype.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BitChunkQueue.h"
+
+/// <summary>
+/// A buffered character reader over a file or a block of memory.
+/// Files are read in chunks with partial reads, so interactive input is handed on as soon as it arrives
+/// and the size of the source never matters. The last few characters stay in the buffer for error messages.
+/// A prefetching reader reads the file on a thread of its own, the chunks wait in a BitChunkQueue until the
+/// buffer runs empty. The thread starts with the first read.
+/// </summary>
+class BitReader
+{
+public:
+	static const size_t buffer_size = 1 << 16;
+	static const size_t history_size = 64;
+
+	BitReader(FILE* file, bool prefetch = false);
+	BitReader(const char* begin, const char* end);
+	~BitReader();
+	BitReader(const BitReader&) = delete;
+	BitReader& operator=(const BitReader&) = delete;
+
+	inline int peek() {
+		if (current == limit && !fill()) {
+			return EOF;
+		}
+		return (unsigned char)*current;
+	}
+
+	inline void advance() {
+		current++;
+	}
+
+	// True if the next character can be read without waiting.
+	inline bool is_buffered() const {
+		return current != limit || (queue != NULL && queue->is_ready());
+	}
+
+	inline int offset() const {
+		return base + (int)(current - data);
+	}
+
+	inline void skip_whitespace() {
+		int character;
+		while ((character = peek()) != EOF && isspace(character)) {
+			advance();
+		}
+	}
+
+	bool at_end();
+	// Moves a reader over a block of memory to the offset, to read a part of it.
+	inline void seek(int offset) {
+		current = data + (offset - base);
+	}
+	// The buffered characters between the offsets from and to, from is moved forward if they are gone already.
+	std::string excerpt(int& from, int to) const;
+
+private:
+	FILE* file;
+	std::vector<char> storage;
+	const char* data;
+	const char* current;
+	const char* limit;
+	int base;
+	bool eof;
+	bool prefetch;
+	// Shared with the thread, which ends when it is closed and may still wait for the file then.
+	std::shared_ptr<BitChunkQueue> queue;
+
+	bool fill();
+	void start_prefetch();
+};
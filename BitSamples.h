@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct BitSample {
+	std::string name;
+	std::string source;
+	// The bits the READs of the program take.
+	std::string input;
+};
+
+/// <summary>
+/// The example programs that come with the interpreter, measured by the benchmarks and run on every
+/// backend by the tests. repeatones_orig ends with a runtime error.
+/// </summary>
+class BitSamples
+{
+public:
+	static const std::vector<BitSample>& all();
+};
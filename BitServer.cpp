@@ -0,0 +1,276 @@
+#include "BitServer.h"
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include "BitParser.h"
+#include "BitCompiled.h"
+#include "BitNodes.h"
+#include "BitError.h"
+#include "BitReader.h"
+#include "BitWriter.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Requests larger than this are malformed, it keeps a broken client from making the server allocate any size.
+static const size_t max_request_size = 1 << 28;
+
+
+BitServer::BitServer(const BitOptions& options, size_t cache_size) : options(options), cache_size(cache_size), stopping(false), requests(0), cache_hits(0)
+{
+	this->options.cancel = &stopping;
+}
+
+
+BitServer::~BitServer()
+{
+	stopping = true;
+}
+
+
+void BitServer::serve(FILE* input, FILE* output)
+{
+	string line;
+	string source;
+	string input_bits;
+	Response response;
+	while (read_line(input, line) && line != "QUIT") {
+		if (line == "STATS") {
+			response = { "OK", 0, 0, false, "", "" };
+			write_stats(response.output);
+			write_response(output, response);
+			continue;
+		}
+		unsigned long long source_size = 0;
+		unsigned long long input_size = 0;
+		unsigned long long max_steps = options.max_steps;
+		int time_limit = options.time_limit;
+		int fields = sscanf(line.c_str(), "RUN %llu %llu %llu %d", &source_size, &input_size, &max_steps, &time_limit);
+		bool valid = line.compare(0, 4, "RUN ") == 0 && fields >= 2 && time_limit >= 0
+			&& source_size <= max_request_size && input_size <= max_request_size;
+		if (!valid || !read_bytes(input, (size_t)source_size, source) || !read_bytes(input, (size_t)input_size, input_bits)) {
+			response = { "ERROR", 0, 0, false, "", "Malformed request: " + line.substr(0, 80) };
+			write_response(output, response);
+			return;
+		}
+		BitOptions run_options = options;
+		run_options.max_steps = max_steps;
+		run_options.time_limit = time_limit;
+		execute(source, input_bits, run_options, response);
+		write_response(output, response);
+	}
+}
+
+
+bool BitServer::listen(const char* path)
+{
+#ifdef _WIN32
+	return false;
+#else
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		return false;
+	}
+	strcpy(address.sun_path, path);
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0) {
+		return false;
+	}
+	unlink(path);
+	if (::bind(server, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(server, SOMAXCONN) != 0) {
+		close(server);
+		return false;
+	}
+	// A client that goes away while its response is written only ends its own connection.
+	signal(SIGPIPE, SIG_IGN);
+	for (;;) {
+		int connection = accept(server, NULL, NULL);
+		if (connection < 0) {
+			continue;
+		}
+		thread([this, connection]() {
+			FILE* input = fdopen(connection, "rb");
+			FILE* output = fdopen(dup(connection), "wb");
+			if (input != NULL && output != NULL) {
+				serve(input, output);
+			}
+			if (output != NULL) {
+				fclose(output);
+			}
+			if (input != NULL) {
+				fclose(input);
+			}
+			else {
+				close(connection);
+			}
+		}).detach();
+	}
+#endif
+}
+
+
+// Finds the program of the source in the cache or parses it. The parse runs outside the lock, so
+// connections only wait for each other to look up and add programs.
+shared_ptr<const BitServer::Entry> BitServer::prepare(const string& source, bool& cached)
+{
+	const char* begin = source.data();
+	const char* end = begin + source.size();
+	uint64_t hash = BitCompiled::hash(begin, end);
+	{
+		lock_guard<mutex> guard(lock);
+		requests++;
+		auto found = cache.find(hash);
+		if (found != cache.end() && found->second.entry->source == source) {
+			uses.splice(uses.begin(), uses, found->second.use);
+			cache_hits++;
+			cached = true;
+			return found->second.entry;
+		}
+	}
+	cached = false;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	shared_ptr<Entry> entry(new Entry());
+	entry->source = source;
+	// An error of one request, also of a program that fails to compile, is the response of that request only.
+	try {
+		if (BitCompiled::is_compiled(begin, end)) {
+			vector<unique_ptr<CodeNode>> programs;
+			if (!BitCompiled::load(begin, end, programs)) {
+				entry->error = "The compiled file is damaged or of another version.";
+			}
+			else if (programs.size() != 1) {
+				entry->error = "The compiled file holds " + to_string(programs.size()) + " programs, a request runs one.";
+			}
+			else {
+				entry->program.reset(new BitProgram(programs[0].release(), options));
+			}
+		}
+		else {
+			BitReader reader(begin, end);
+			BitParser parser(reader);
+			entry->program.reset(new BitProgram(parser.parse(options.optimize), options));
+			entry->input = source.substr(min((size_t)reader.offset(), source.size()));
+		}
+	}
+	catch (const BitParserError& error) {
+		entry->error = string(error.what()) + ". Position " + to_string(error.position);
+	}
+	catch (const exception& error) {
+		entry->error = error.what();
+	}
+	lock_guard<mutex> guard(lock);
+	metrics.parses++;
+	metrics.parse_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	auto found = cache.find(hash);
+	if (found != cache.end()) {
+		uses.erase(found->second.use);
+		cache.erase(found);
+	}
+	uses.push_front(hash);
+	cache[hash] = { entry, uses.begin() };
+	while (cache.size() > cache_size && !uses.empty()) {
+		cache.erase(uses.back());
+		uses.pop_back();
+	}
+	return entry;
+}
+
+
+void BitServer::execute(const string& source, const string& input, const BitOptions& run_options, Response& response)
+{
+	response.steps = 0;
+	response.microseconds = 0;
+	response.output.clear();
+	response.message.clear();
+	shared_ptr<const Entry> entry = prepare(source, response.cached);
+	if (entry->program == NULL) {
+		response.status = "ERROR";
+		response.message = entry->error;
+		return;
+	}
+	const string& bits = input.empty() ? entry->input : input;
+	BitReader reader(bits.data(), bits.data() + bits.size());
+	BitWriter writer(response.output);
+	BitInterpreter interpreter(reader, writer, run_options);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	try {
+		interpreter.run(*entry->program);
+		writer.flush();
+		response.status = "OK";
+	}
+	catch (const BitLimitError& error) {
+		writer.flush();
+		response.status = "STOPPED";
+		response.message = error.what();
+	}
+	catch (const exception& error) {
+		writer.flush();
+		response.status = "RUNTIME_ERROR";
+		response.message = error.what();
+	}
+	response.microseconds = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+	response.steps = interpreter.step_count();
+	lock_guard<mutex> guard(lock);
+	metrics.add(interpreter.metrics);
+}
+
+
+void BitServer::write_stats(string& text)
+{
+	ostringstream out;
+	lock_guard<mutex> guard(lock);
+	metrics.write_prometheus(out);
+	out << "# HELP bit_server_requests_total Requests that ran a program or reported its syntax error.\n";
+	out << "# TYPE bit_server_requests_total counter\n";
+	out << "bit_server_requests_total " << requests << "\n";
+	out << "# HELP bit_server_cache_hits_total Requests whose program was cached.\n";
+	out << "# TYPE bit_server_cache_hits_total counter\n";
+	out << "bit_server_cache_hits_total " << cache_hits << "\n";
+	out << "# HELP bit_server_cached_programs Programs in the cache.\n";
+	out << "# TYPE bit_server_cached_programs gauge\n";
+	out << "bit_server_cached_programs " << cache.size() << "\n";
+	text = out.str();
+}
+
+
+bool BitServer::read_line(FILE* input, string& line)
+{
+	line.clear();
+	for (int character = getc(input); character != EOF; character = getc(input)) {
+		if (character == '\n') {
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			return true;
+		}
+		if (line.size() < 256) {
+			line += (char)character;
+		}
+	}
+	return !line.empty();
+}
+
+
+bool BitServer::read_bytes(FILE* input, size_t size, string& bytes)
+{
+	bytes.resize(size);
+	return size == 0 || fread(&bytes[0], 1, size, input) == size;
+}
+
+
+void BitServer::write_response(FILE* output, const Response& response)
+{
+	fprintf(output, "%s %llu %lld %d %zu %zu\n", response.status, (unsigned long long)response.steps, (long long)response.microseconds,
+		response.cached ? 1 : 0, response.output.size(), response.message.size());
+	fwrite(response.output.data(), 1, response.output.size(), output);
+	fwrite(response.message.data(), 1, response.message.size(), output);
+	fflush(output);
+}
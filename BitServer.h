@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "BitInterpreter.h"
+#include "BitProgram.h"
+
+/// <summary>
+/// A long running interpreter for graders and other tools with many short runs. Requests come over the
+/// standard input or the connections of a Unix socket, each one is a source and the input of its READs.
+/// Programs are cached by a hash of their source (or compiled file), a repeated source skips the parser
+/// and the compiler. Every response is the output of the run or its error, with its steps and time.
+///
+/// A request is a line and the bytes it announces:
+///   RUN source_size input_size [max_steps [time_limit]]\n source input
+/// The limits override the ones of the options, zero means no limit. An empty input reads the source after
+/// the program's ; like the standard input. The response is a line and the output and message it announces:
+///   status steps microseconds cached output_size message_size\n output message
+/// The status is OK, ERROR for syntax errors, RUNTIME_ERROR or STOPPED. The time is that of the run, the
+/// parse of a source that wasn't cached is not included. QUIT ends the connection, a malformed request
+/// gets an ERROR response and ends it as well. STATS is answered with the metrics of all runs so far in the
+/// Prometheus text format as the output of an OK response.
+/// Connections are served on threads of their own, the cache is shared by all of them.
+/// </summary>
+class BitServer
+{
+public:
+	BitServer(const BitOptions& options, size_t cache_size = 1024);
+	~BitServer();
+	BitServer(const BitServer&) = delete;
+	BitServer& operator=(const BitServer&) = delete;
+
+	// Answers the requests of the input until it ends or QUIT.
+	void serve(FILE* input, FILE* output);
+	// Accepts connections on a Unix socket at the path until the process ends, only fails if the socket
+	// can't be created.
+	bool listen(const char* path);
+
+private:
+	struct Entry {
+		std::string source;
+		// NULL if the source has a syntax error.
+		std::unique_ptr<BitProgram> program;
+		std::string input;
+		std::string error;
+	};
+
+	// Entries are shared with the runs, so a run keeps its program when it is dropped from the cache.
+	struct Slot {
+		std::shared_ptr<const Entry> entry;
+		std::list<uint64_t>::iterator use;
+	};
+
+	struct Response {
+		const char* status;
+		uint64_t steps;
+		int64_t microseconds;
+		bool cached;
+		std::string output;
+		std::string message;
+	};
+
+	BitOptions options;
+	size_t cache_size;
+	// Set when the server is destroyed, running programs stop. It also makes the programs count their steps.
+	std::atomic<bool> stopping;
+	std::mutex lock;
+	std::unordered_map<uint64_t, Slot> cache;
+	// The hashes of the cache, the most recently used first.
+	std::list<uint64_t> uses;
+	// The metrics of every run and parse, guarded by the lock like the cache.
+	BitMetrics metrics;
+	uint64_t requests;
+	uint64_t cache_hits;
+
+	std::shared_ptr<const Entry> prepare(const std::string& source, bool& cached);
+	void execute(const std::string& source, const std::string& input, const BitOptions& run_options, Response& response);
+	void write_stats(std::string& text);
+	static bool read_line(FILE* input, std::string& line);
+	static bool read_bytes(FILE* input, size_t size, std::string& bytes);
+	static void write_response(FILE* output, const Response& response);
+};
@@ -0,0 +1,354 @@
+#include "BitSliced.h"
+#include <queue>
+#include <functional>
+#include <unordered_map>
+#include <ctype.h>
+#include "BitValue.h"
+
+using namespace std;
+
+// One bit for every lane. The loops over the words are simple enough for the compiler to vectorize.
+template<int Words>
+struct Lanes {
+	uint64_t words[Words];
+
+	static Lanes none() {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = 0;
+		}
+		return lanes;
+	}
+
+	static Lanes all() {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = ~(uint64_t)0;
+		}
+		return lanes;
+	}
+
+	static Lanes first(int count) {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			int bits = count - i * 64;
+			lanes.words[i] = bits >= 64 ? ~(uint64_t)0 : bits <= 0 ? 0 : ((uint64_t)1 << bits) - 1;
+		}
+		return lanes;
+	}
+
+	bool any() const {
+		uint64_t bits = 0;
+		for (int i = 0; i < Words; i++) {
+			bits |= words[i];
+		}
+		return bits != 0;
+	}
+
+	void set(int lane) {
+		words[lane >> 6] |= (uint64_t)1 << (lane & 63);
+	}
+
+	Lanes operator&(const Lanes& other) const {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = words[i] & other.words[i];
+		}
+		return lanes;
+	}
+
+	Lanes operator|(const Lanes& other) const {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = words[i] | other.words[i];
+		}
+		return lanes;
+	}
+
+	Lanes operator~() const {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = ~words[i];
+		}
+		return lanes;
+	}
+
+	// The lanes of the mask from this, the others from other.
+	Lanes select(const Lanes& mask, const Lanes& other) const {
+		Lanes lanes;
+		for (int i = 0; i < Words; i++) {
+			lanes.words[i] = (words[i] & mask.words[i]) | (other.words[i] & ~mask.words[i]);
+		}
+		return lanes;
+	}
+};
+
+// A bit of every lane, the compiled programs only have bits.
+template<int Words>
+static inline Lanes<Words> sliced_nand(const Lanes<Words>& left, const Lanes<Words>& right) {
+	return ~(left & right);
+}
+
+static inline int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	int index = 0;
+	while ((bits & 1) == 0) {
+		bits >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+template<int Words, class Function>
+static void for_each_lane(const Lanes<Words>& lanes, Function function) {
+	for (int i = 0; i < Words; i++) {
+		uint64_t bits = lanes.words[i];
+		while (bits != 0) {
+			function(i * 64 + lowest_bit(bits));
+			bits &= bits - 1;
+		}
+	}
+}
+
+struct LaneInput {
+	const char* current;
+	const char* end;
+	uint8_t byte;
+	int bit_count;
+};
+
+// Reads a bit the way the interpreter does, returns -1 and the error if there is none.
+static int read_lane(LaneInput& input, bool read_ascii, const char*& error) {
+	if (read_ascii) {
+		if (input.bit_count == 0) {
+			if (input.current == input.end) {
+				error = "No input left to read.";
+				return -1;
+			}
+			input.byte = (uint8_t)*input.current++;
+			input.bit_count = 8;
+		}
+		input.bit_count--;
+		return (input.byte >> input.bit_count) & 1;
+	}
+	while (input.current != input.end && isspace((unsigned char)*input.current)) {
+		input.current++;
+	}
+	if (input.current == input.end || (*input.current != '0' && *input.current != '1')) {
+		error = "Invalid value read.";
+		return -1;
+	}
+	return *input.current++ - '0';
+}
+
+
+BitSlicedProgram::BitSlicedProgram() : entry(0), max_stack_depth(0), slot_count(0)
+{
+}
+
+
+bool BitSlicedProgram::compile(const BytecodeProgram& program)
+{
+	unordered_map<int, int> slots;
+	slots[jump_register_address] = 0;
+	code.clear();
+	joins.assign(program.code.size() + 1, false);
+	joins[program.entry] = true;
+	for (Instruction instruction : program.code) {
+		switch (instruction.op) {
+		case OP_PUSH_CONST:
+		case OP_PUSH_BIT:
+			if (instruction.operand != 0 && instruction.operand != 1) {
+				return false;
+			}
+			break;
+		case OP_LOAD_VAR:
+		case OP_STORE:
+		case OP_STORE_BIT:
+			instruction.operand = slots.try_emplace(instruction.operand, (int)slots.size()).first->second;
+			break;
+		case OP_JMP:
+		case OP_JZ:
+		case OP_JO:
+			joins[instruction.operand] = true;
+			break;
+		case OP_NAND:
+		case OP_NOT:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_PRINT:
+		case OP_PRINT_BITS:
+		case OP_READ:
+		case OP_HALT:
+			break;
+		default:
+			return false;
+		}
+		code.push_back(instruction);
+	}
+	strings = program.strings;
+	entry = program.entry;
+	max_stack_depth = program.max_stack_depth;
+	slot_count = (int)slots.size();
+	return true;
+}
+
+
+void BitSlicedProgram::run(const vector<const string*>& inputs, bool read_ascii, bool print_ascii, vector<Result>& results) const
+{
+	results.assign(inputs.size(), Result());
+	if (inputs.size() <= 64) {
+		run_lanes<1>(inputs, read_ascii, results);
+	}
+	else if (inputs.size() <= 256) {
+		run_lanes<4>(inputs, read_ascii, results);
+	}
+	else {
+		run_lanes<8>(inputs, read_ascii, results);
+	}
+	if (print_ascii) {
+		// Bits that don't fill a character are never printed.
+		for (Result& result : results) {
+			string characters;
+			for (size_t i = 0; i + 8 <= result.output.size(); i += 8) {
+				uint8_t character = 0;
+				for (size_t bit = i; bit < i + 8; bit++) {
+					character = (uint8_t)((character << 1) | (result.output[bit] - '0'));
+				}
+				characters += (char)character;
+			}
+			result.output.swap(characters);
+		}
+	}
+}
+
+
+template<int Words>
+void BitSlicedProgram::run_lanes(const vector<const string*>& inputs, bool read_ascii, vector<Result>& results) const
+{
+	typedef Lanes<Words> Mask;
+	int count = (int)inputs.size();
+	vector<LaneInput> lane_inputs(count);
+	for (int lane = 0; lane < count; lane++) {
+		lane_inputs[lane] = { inputs[lane]->data(), inputs[lane]->data() + inputs[lane]->size(), 0, 0 };
+	}
+	vector<Mask> slots(slot_count, Mask::none());
+	vector<Mask> stack(max_stack_depth + 1);
+	// The lanes waiting at every instruction, the lowest instruction runs next.
+	vector<Mask> waiting(code.size() + 1, Mask::none());
+	priority_queue<int, vector<int>, greater<int>> ready;
+	auto defer = [&](int pc, const Mask& lanes) {
+		if (!lanes.any()) {
+			return;
+		}
+		if (!waiting[pc].any()) {
+			ready.push(pc);
+		}
+		waiting[pc] = waiting[pc] | lanes;
+	};
+	defer(entry, Mask::first(count));
+
+	while (!ready.empty()) {
+		int pc = ready.top();
+		ready.pop();
+		Mask active = waiting[pc];
+		waiting[pc] = Mask::none();
+		Mask* sp = stack.data();
+		while (active.any()) {
+			const Instruction& instruction = code[pc];
+			switch (instruction.op) {
+			case OP_PUSH_CONST:
+			case OP_PUSH_BIT:
+				*sp++ = instruction.operand ? Mask::all() : Mask::none();
+				break;
+			case OP_LOAD_VAR:
+				*sp++ = slots[instruction.operand];
+				break;
+			case OP_NAND:
+				sp--;
+				sp[-1] = sliced_nand(sp[-1], sp[0]);
+				break;
+			case OP_NOT:
+				sp[-1] = sliced_nand(sp[-1], sp[-1]);
+				break;
+			case OP_AND:
+				{
+					sp--;
+					Mask both = sliced_nand(sp[-1], sp[0]);
+					sp[-1] = sliced_nand(both, both);
+				}
+				break;
+			case OP_OR:
+				sp--;
+				sp[-1] = sliced_nand(sliced_nand(sp[-1], sp[-1]), sliced_nand(sp[0], sp[0]));
+				break;
+			case OP_XOR:
+				{
+					sp--;
+					Mask both = sliced_nand(sp[-1], sp[0]);
+					sp[-1] = sliced_nand(sliced_nand(sp[-1], both), sliced_nand(sp[0], both));
+				}
+				break;
+			case OP_STORE:
+			case OP_STORE_BIT:
+				sp--;
+				slots[instruction.operand] = sp->select(active, slots[instruction.operand]);
+				break;
+			case OP_PRINT:
+				for_each_lane(active, [&](int lane) {
+					results[lane].output += (char)('0' + instruction.operand);
+				});
+				break;
+			case OP_PRINT_BITS:
+				for_each_lane(active, [&](int lane) {
+					results[lane].output += strings[instruction.operand];
+				});
+				break;
+			case OP_READ:
+				{
+					Mask ones = Mask::none();
+					Mask failed = Mask::none();
+					for_each_lane(active, [&](int lane) {
+						const char* error = NULL;
+						int bit = read_lane(lane_inputs[lane], read_ascii, error);
+						if (bit < 0) {
+							results[lane].error = error;
+							failed.set(lane);
+						}
+						else if (bit == 1) {
+							ones.set(lane);
+						}
+					});
+					active = active & ~failed;
+					slots[0] = ones.select(active, slots[0]);
+				}
+				break;
+			case OP_JMP:
+				defer(instruction.operand, active);
+				active = Mask::none();
+				break;
+			case OP_JZ:
+				defer(instruction.operand, active & ~slots[0]);
+				active = active & slots[0];
+				break;
+			case OP_JO:
+				defer(instruction.operand, active & slots[0]);
+				active = active & ~slots[0];
+				break;
+			default:
+				active = Mask::none();
+				break;
+			}
+			pc++;
+			// Lanes that arrived here on other paths, or wait further up, run first.
+			if (joins[pc] && !ready.empty() && ready.top() <= pc) {
+				defer(pc, active);
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "BitBytecode.h"
+
+/// <summary>
+/// Runs one program for many inputs at once by bit slicing. Every variable is a row of words with one
+/// bit per execution (a lane), so a NAND is a few word operations for up to max_lanes executions.
+/// Lanes take their own paths: the lanes waiting at the lowest instruction run together under a mask,
+/// and lanes that jump to the same line run together again from there. Printing and reading are done
+/// for every lane on its own, a lane that fails stops while the others go on.
+/// Programs with pointer operators or GOTO VARIABLE are not compiled.
+/// </summary>
+class BitSlicedProgram
+{
+public:
+	static const int max_lanes = 512;
+
+	struct Result {
+		std::string output;
+		// Empty if the lane ran to its end.
+		std::string error;
+	};
+
+	BitSlicedProgram();
+	BitSlicedProgram(const BitSlicedProgram&) = delete;
+	BitSlicedProgram& operator=(const BitSlicedProgram&) = delete;
+
+	bool compile(const BytecodeProgram& program);
+	// Runs the program once for every input, up to max_lanes of them. An input is read like the
+	// source after the ; of a program. In ASCII mode the output is packed like the interpreter does.
+	void run(const std::vector<const std::string*>& inputs, bool read_ascii, bool print_ascii, std::vector<Result>& results) const;
+
+private:
+	// The bytecode with variables renumbered to slots, slot 0 is the jump register.
+	std::vector<Instruction> code;
+	std::vector<std::string> strings;
+	// Instructions where lanes can join, the entry and every jump target.
+	std::vector<bool> joins;
+	int entry;
+	int max_stack_depth;
+	int slot_count;
+
+	template<int Words> void run_lanes(const std::vector<const std::string*>& inputs, bool read_ascii, std::vector<Result>& results) const;
+};
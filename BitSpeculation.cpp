@@ -0,0 +1,70 @@
+#include "BitSpeculation.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+
+BitSpeculation::BitSpeculation(const BitOptions& options) : reader(no_input.data(), no_input.data()), writer(printed),
+	interpreter(reader, writer, branch_options(options)), cancelled(false), stopped(false)
+{
+	interpreter.options.cancel = &cancelled;
+	interpreter.speculative = true;
+}
+
+
+BitSpeculation::~BitSpeculation()
+{
+	cancel();
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+
+void BitSpeculation::start(const BitProgram& program, int pc)
+{
+	thread = std::thread([this, &program, pc]() {
+#ifdef SCHED_IDLE
+		// Branches only use cores that are idle otherwise, the interpreter and the other programs of the host come first.
+		sched_param parameters = {};
+		pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameters);
+#endif
+		try {
+			interpreter.execute(program, pc);
+			stopped = true;
+		}
+		catch (const exception&) {
+			stopped = false;
+		}
+		writer.flush();
+	});
+}
+
+
+void BitSpeculation::cancel()
+{
+	cancelled = true;
+}
+
+
+bool BitSpeculation::finish()
+{
+	if (thread.joinable()) {
+		thread.join();
+	}
+	return stopped;
+}
+
+
+// A branch is never traced, it only runs while the interpreter doesn't check for endless loops.
+BitOptions BitSpeculation::branch_options(const BitOptions& options)
+{
+	BitOptions branch = options;
+	branch.trace = false;
+	branch.cycle_mode = CYCLES_IGNORED;
+	return branch;
+}
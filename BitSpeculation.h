@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include "BitInterpreter.h"
+
+/// <summary>
+/// A run of the lines after a READ for one value of the bit, on a thread of its own while the interpreter
+/// waits for the input. The interpreter of the branch starts with a copy of the memory that shares its
+/// pages, reads no input and prints into a buffer. It stops before the next READ or at the end of the
+/// program, errors and limits discard it. When the bit arrives, the interpreter takes over the state of
+/// the branch of that bit as if it had run the lines itself, so the output is the same as without it.
+/// </summary>
+class BitSpeculation
+{
+public:
+	// The most lines a branch runs before it is discarded.
+	static const uint64_t max_lines = 1 << 20;
+
+	BitSpeculation(const BitOptions& options);
+	// Cancels the branch if it still runs.
+	~BitSpeculation();
+	BitSpeculation(const BitSpeculation&) = delete;
+	BitSpeculation& operator=(const BitSpeculation&) = delete;
+
+	// Runs the program from the instruction on a thread, the interpreter must be prepared before.
+	void start(const BitProgram& program, int pc);
+	void cancel();
+	// Waits for the branch to stop, true if it stopped before a READ or at the end.
+	bool finish();
+
+	BitInterpreter& branch() { return interpreter; };
+	// Complete after finish().
+	const std::string& output() const { return printed; };
+
+private:
+	std::string printed;
+	std::string no_input;
+	BitReader reader;
+	BitWriter writer;
+	BitInterpreter interpreter;
+	std::atomic<bool> cancelled;
+	bool stopped;
+	std::thread thread;
+
+	static BitOptions branch_options(const BitOptions& options);
+};
@@ -0,0 +1,84 @@
+#include "BitThreadPool.h"
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+
+BitThreadPool::BitThreadPool(int thread_count) : thread_count(thread_count)
+{
+	if (this->thread_count <= 0) {
+		this->thread_count = max(1, (int)thread::hardware_concurrency());
+	}
+}
+
+
+void BitThreadPool::run(size_t count, const function<void(size_t)>& task)
+{
+	size_t threads = min((size_t)thread_count, count);
+	if (threads <= 1) {
+		for (size_t index = 0; index < count; index++) {
+			task(index);
+		}
+		return;
+	}
+	vector<Queue> queues(threads);
+	for (size_t i = 0; i < threads; i++) {
+		for (size_t index = count * i / threads; index < count * (i + 1) / threads; index++) {
+			queues[i].indexes.push_back(index);
+		}
+	}
+	vector<thread> workers;
+	for (size_t i = 1; i < threads; i++) {
+		workers.emplace_back(work, ref(queues), i, cref(task));
+	}
+	work(queues, 0, task);
+	for (thread& worker : workers) {
+		worker.join();
+	}
+}
+
+
+bool BitThreadPool::pop(Queue& queue, size_t& index)
+{
+	lock_guard<mutex> guard(queue.lock);
+	if (queue.indexes.empty()) {
+		return false;
+	}
+	index = queue.indexes.front();
+	queue.indexes.pop_front();
+	return true;
+}
+
+
+bool BitThreadPool::steal(Queue& queue, size_t& index)
+{
+	lock_guard<mutex> guard(queue.lock);
+	if (queue.indexes.empty()) {
+		return false;
+	}
+	index = queue.indexes.back();
+	queue.indexes.pop_back();
+	return true;
+}
+
+
+// No tasks are added while the batch runs, a thread is done when all queues are empty.
+void BitThreadPool::work(vector<Queue>& queues, size_t first, const function<void(size_t)>& task)
+{
+	size_t index;
+	for (;;) {
+		if (pop(queues[first], index)) {
+			task(index);
+			continue;
+		}
+		bool stolen = false;
+		for (size_t i = 1; i < queues.size() && !stolen; i++) {
+			stolen = steal(queues[(first + i) % queues.size()], index);
+		}
+		if (!stolen) {
+			return;
+		}
+		task(index);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// Runs a batch of indexed tasks on a fixed number of threads with work stealing.
+/// Every thread starts with an equal, contiguous share of the indexes and takes them from the front
+/// of its own queue. A thread whose queue is empty steals from the back of the other queues, so
+/// a few long tasks don't hold up the rest of the batch. Tasks must not throw.
+/// </summary>
+class BitThreadPool
+{
+public:
+	// With zero threads, one thread runs for every core.
+	BitThreadPool(int thread_count = 0);
+	BitThreadPool(const BitThreadPool&) = delete;
+	BitThreadPool& operator=(const BitThreadPool&) = delete;
+
+	int size() const { return thread_count; };
+	// Calls task(index) for every index below count and returns when all calls are done.
+	void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+	struct Queue {
+		std::mutex lock;
+		std::deque<size_t> indexes;
+	};
+
+	int thread_count;
+
+	static bool pop(Queue& queue, size_t& index);
+	static bool steal(Queue& queue, size_t& index);
+	static void work(std::vector<Queue>& queues, size_t first, const std::function<void(size_t)>& task);
+};
@@ -0,0 +1,174 @@
+#include "BitTrace.h"
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "BitNodes.h"
+
+using namespace std;
+
+static const char magic[4] = { 'B', 'I', 'T', 'T' };
+static const uint32_t version = 1;
+
+// The numbers of a trace file are little endian, independent of the byte order of the machine.
+static void put32(string& data, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		data += (char)(value >> (i * 8));
+	}
+}
+
+static void put64(string& data, uint64_t value) {
+	put32(data, (uint32_t)value);
+	put32(data, (uint32_t)(value >> 32));
+}
+
+// Reads are checked against the size of the file before.
+static uint32_t get32(const char*& current) {
+	uint32_t value = 0;
+	for (int i = 0; i < 4; i++) {
+		value |= (uint32_t)(uint8_t)*current++ << (i * 8);
+	}
+	return value;
+}
+
+
+BitTrace::BitTrace(size_t capacity) : count(0), current(&spare)
+{
+	size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	entries.resize(size);
+	mask = size - 1;
+}
+
+
+void BitTrace::clear()
+{
+	count = 0;
+	current = &spare;
+}
+
+
+bool BitTrace::save(const string& path, const CodeNode& code) const
+{
+	uint64_t kept = min(count, (uint64_t)entries.size());
+	string data(magic, sizeof(magic));
+	put32(data, version);
+	put64(data, count - kept);
+	put32(data, (uint32_t)code.table.size());
+	put32(data, (uint32_t)kept);
+	for (const LineNode* line : code.table) {
+		put32(data, (uint32_t)line->line_number);
+		put32(data, (uint32_t)line->position);
+	}
+	for (uint64_t i = count - kept; i < count; i++) {
+		const Entry& entry = entries[i & mask];
+		put32(data, (uint32_t)entry.line);
+		put32(data, (uint32_t)entry.jump_register);
+		put32(data, (uint32_t)entry.address);
+		put32(data, entry.value);
+	}
+	ofstream file(path, ios::binary | ios::trunc);
+	return (bool)file.write(data.data(), data.size());
+}
+
+
+bool BitTrace::Decoded::load(const char* begin, const char* end)
+{
+	entries.clear();
+	line_numbers.clear();
+	positions.clear();
+	const size_t header_size = sizeof(magic) + 20;
+	if ((size_t)(end - begin) < header_size || memcmp(begin, magic, sizeof(magic)) != 0) {
+		return false;
+	}
+	const char* current = begin + sizeof(magic);
+	uint32_t file_version = get32(current);
+	skipped = get32(current);
+	skipped |= (uint64_t)get32(current) << 32;
+	uint32_t line_count = get32(current);
+	uint32_t entry_count = get32(current);
+	// Both tables have to fill the rest of the file before anything is allocated.
+	if (file_version != version || (uint64_t)line_count * 8 + (uint64_t)entry_count * 16 != (uint64_t)(end - current)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < line_count; i++) {
+		line_numbers.push_back((int)get32(current));
+		positions.push_back((int)get32(current));
+	}
+	for (uint32_t i = 0; i < entry_count; i++) {
+		Entry entry;
+		entry.line = (int32_t)get32(current);
+		entry.jump_register = (int32_t)get32(current);
+		entry.address = (int32_t)get32(current);
+		entry.value = get32(current);
+		if (entry.line < 0 || (uint32_t)entry.line >= line_count) {
+			return false;
+		}
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+
+static string describe(Value value) {
+	switch (value.type()) {
+	case BIT:
+		return "BIT " + to_string(value.payload());
+	case ADDRESS_OF_A_BIT:
+		return "ADDRESS OF " + to_string(value.payload());
+	default:
+		return to_string(value.payload());
+	}
+}
+
+
+// The text of a line reaches to the start of the next line in the source, whitespace is shown as single spaces.
+static string line_text(const string& source, const vector<int>& starts, int position) {
+	if (position < 0 || (size_t)position >= source.size()) {
+		return "";
+	}
+	auto next = upper_bound(starts.begin(), starts.end(), position);
+	size_t end = next != starts.end() ? (size_t)*next : source.size();
+	end = min(end, (size_t)position + 72);
+	string text;
+	for (size_t i = (size_t)position; i < end; i++) {
+		char character = isspace((unsigned char)source[i]) ? ' ' : source[i];
+		if (character != ' ' || (!text.empty() && text.back() != ' ')) {
+			text += character;
+		}
+	}
+	while (!text.empty() && text.back() == ' ') {
+		text.pop_back();
+	}
+	return text;
+}
+
+
+void BitTrace::Decoded::write_text(ostream& out, const string* source) const
+{
+	vector<int> starts(positions);
+	sort(starts.begin(), starts.end());
+	out << "The last " << entries.size() << " of " << skipped + entries.size() << " lines, the oldest first\n";
+	out << "        step      line    offset  jump  write\n";
+	for (size_t i = 0; i < entries.size(); i++) {
+		const Entry& entry = entries[i];
+		out << setw(12) << skipped + i + 1 << setw(10) << line_numbers[entry.line] << setw(10) << positions[entry.line]
+			<< setw(6) << entry.jump_register << "  ";
+		if (entry.address == no_write) {
+			out << "-";
+		}
+		else if (entry.address == jump_register_address) {
+			out << "JUMP REGISTER = " << describe({ entry.value });
+		}
+		else {
+			out << "VARIABLE " << entry.address << " = " << describe({ entry.value });
+		}
+		if (source != NULL) {
+			out << "  | " << line_text(*source, starts, positions[entry.line]);
+		}
+		out << "\n";
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <climits>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BitValue.h"
+
+class CodeNode;
+
+// Define BIT_NO_TRACING to compile the tracing hooks out of the interpreters.
+#ifndef BIT_NO_TRACING
+#define BIT_TRACING
+#endif
+
+/// <summary>
+/// The last lines a program ran, for finding out how it got into a failure. Every line is an entry of a
+/// fixed ring in memory: the index of the line, the jump register before it ran and the address and value
+/// it wrote, if it wrote one. Recording a line is a store of its entry, the oldest entries are overwritten.
+/// A trace is saved to a binary file with the line numbers and source offsets of its program, so it can
+/// be decoded after the program was released.
+/// </summary>
+class BitTrace
+{
+public:
+	struct Entry {
+		int32_t line;
+		int32_t jump_register;
+		int32_t address;
+		uint32_t value;
+	};
+
+	// The address of a line that didn't write.
+	static const int32_t no_write = INT32_MIN;
+
+	// The capacity is rounded up to a power of two.
+	BitTrace(size_t capacity = 1 << 16);
+
+	inline void line(int index, int jump_register) {
+		current = &entries[count++ & mask];
+		*current = { index, jump_register, no_write, 0 };
+	}
+
+	inline void write(int address, Value value) {
+		current->address = address;
+		current->value = value.word;
+	}
+
+	void clear();
+	// The lines recorded since the trace was cleared, only the last capacity ones are kept.
+	uint64_t size() const { return count; };
+	size_t capacity() const { return entries.size(); };
+	// Writes the entries of a run of the program, the oldest first. Returns false if the file can't be written.
+	bool save(const std::string& path, const CodeNode& code) const;
+
+	/// <summary>
+	/// A trace loaded from a file, decoded into line numbers and source offsets.
+	/// </summary>
+	struct Decoded {
+		// The lines that ran before the first entry.
+		uint64_t skipped;
+		std::vector<Entry> entries;
+		// Indexed by the line of an entry, offsets are -1 for programs loaded from compiled files.
+		std::vector<int> line_numbers;
+		std::vector<int> positions;
+
+		bool load(const char* begin, const char* end);
+		// Lists the entries with the line number, the source offset and the text of every line if the
+		// source is given.
+		void write_text(std::ostream& out, const std::string* source) const;
+	};
+
+private:
+	std::vector<Entry> entries;
+	uint64_t mask;
+	// Every line that was recorded, the newest entry is at count - 1.
+	uint64_t count;
+	// The entry of the current line, writes before the first line go to a spare entry.
+	Entry* current;
+	Entry spare;
+};
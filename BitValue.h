@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+enum ValueType {
+	UNDEFINED = 0,
+	BIT = 1,
+	ADDRESS_OF_A_BIT = 2
+};
+
+/// <summary>
+/// A value packed into one 32 bit word: the type in the lowest two bits, the bit, address or constant
+/// above them as a signed 30 bit payload. Memory, the bytecode stack and native code store the word as it is.
+/// The zero word is an undefined zero, the value of every cell that was never written.
+/// </summary>
+struct Value {
+	static const int type_bits = 2;
+	static const uint32_t type_mask = (1 << type_bits) - 1;
+	// The largest constant of a program, larger ones don't fit into the payload.
+	static const int max_payload = (1 << (31 - type_bits)) - 1;
+
+	uint32_t word;
+
+	static inline Value make(int payload, ValueType type) {
+		return{ ((uint32_t)payload << type_bits) | (uint32_t)type };
+	}
+
+	inline int payload() const { return (int)word >> type_bits; };
+	inline ValueType type() const { return (ValueType)(word & type_mask); };
+	// NAND takes bits and the undefined zero and one: the address type and every payload bit but the
+	// lowest are clear.
+	inline bool is_bit() const { return (word & ~(uint32_t)((1 << type_bits) | BIT)) == 0; };
+	bool operator==(Value other) const { return word == other.word; };
+	bool operator!=(Value other) const { return word != other.word; };
+};
+
+static_assert(sizeof(Value) == 4, "Native code stores values in 4 byte stack slots.");
+
+// The jump register is addressed like a variable below the first one.
+static const int jump_register_address = -1;
@@ -0,0 +1,102 @@
+#include "BitWriter.h"
+#include <cstring>
+#include <algorithm>
+
+
+BitWriter::BitWriter(FILE* file, bool asynchronous) : file(file), target(NULL), storage(buffer_size), asynchronous(asynchronous)
+{
+	current = storage.data();
+	limit = storage.data() + storage.size();
+}
+
+
+BitWriter::BitWriter(std::string& target) : file(NULL), target(&target), storage(buffer_size), asynchronous(false)
+{
+	current = storage.data();
+	limit = storage.data() + storage.size();
+}
+
+
+BitWriter::~BitWriter()
+{
+	flush();
+	if (queue != NULL) {
+		queue->close();
+		thread.join();
+	}
+}
+
+
+void BitWriter::write(const char* data, size_t size)
+{
+	if (size > (size_t)(limit - current)) {
+		push();
+		if (size > storage.size()) {
+			write_through(data, size);
+			return;
+		}
+	}
+	memcpy(current, data, size);
+	current += size;
+}
+
+
+void BitWriter::push()
+{
+	if (current != storage.data()) {
+		write_through(storage.data(), current - storage.data());
+		current = storage.data();
+	}
+	if (file != NULL && !asynchronous) {
+		fflush(file);
+	}
+}
+
+
+void BitWriter::flush()
+{
+	push();
+	if (queue != NULL) {
+		queue->wait_until_empty();
+	}
+}
+
+
+void BitWriter::write_through(const char* data, size_t size)
+{
+	if (target != NULL) {
+		target->append(data, size);
+	}
+	else if (!asynchronous) {
+		fwrite(data, 1, size, file);
+	}
+	else {
+		if (queue == NULL) {
+			start_thread();
+		}
+		while (size > 0) {
+			BitChunkQueue::Chunk* chunk = queue->begin_write();
+			chunk->size = std::min(size, chunk->data.size());
+			memcpy(chunk->data.data(), data, chunk->size);
+			queue->end_write();
+			data += chunk->size;
+			size -= chunk->size;
+		}
+	}
+}
+
+
+// The file is flushed when the thread caught up, so a stream of chunks is written without waiting for each one.
+void BitWriter::start_thread()
+{
+	queue.reset(new BitChunkQueue(buffer_size));
+	thread = std::thread([this]() {
+		for (const BitChunkQueue::Chunk* chunk = queue->begin_read(); chunk != NULL; chunk = queue->begin_read()) {
+			fwrite(chunk->data.data(), 1, chunk->size, file);
+			if (queue->size() == 1) {
+				fflush(file);
+			}
+			queue->end_read();
+		}
+	});
+}
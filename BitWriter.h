@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include "BitChunkQueue.h"
+
+/// <summary>
+/// A buffered character writer over a file or a string. The buffer is written when it is full or when flush() is called,
+/// the interpreter flushes it at the end of every program and pushes it before it waits for input.
+/// An asynchronous writer hands full buffers to a thread of its own through a BitChunkQueue, so the
+/// interpreter continues while the output is written. The thread starts with the first write.
+/// </summary>
+class BitWriter
+{
+public:
+	static const size_t buffer_size = 1 << 16;
+
+	BitWriter(FILE* file, bool asynchronous = false);
+	// Appends the output to the string.
+	BitWriter(std::string& target);
+	~BitWriter();
+	BitWriter(const BitWriter&) = delete;
+	BitWriter& operator=(const BitWriter&) = delete;
+
+	inline void put(char character) {
+		if (current == limit) {
+			push();
+		}
+		*current++ = character;
+	}
+
+	void write(const char* data, size_t size);
+	// Hands the buffer on to be written, an asynchronous writer doesn't wait for it.
+	void push();
+	// Returns when everything is written.
+	void flush();
+
+private:
+	FILE* file;
+	std::string* target;
+	std::vector<char> storage;
+	char* current;
+	char* limit;
+	bool asynchronous;
+	std::unique_ptr<BitChunkQueue> queue;
+	std::thread thread;
+
+	void write_through(const char* data, size_t size);
+	void start_thread();
+};
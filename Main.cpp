@@ -1,777 +1,528 @@
 #include <iostream>
 #include <string>
-#include <ctype.h>
-#include <list>
-#include <map>
-#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include "BitParser.h"
+#include "BitInterpreter.h"
+#include "BitProgram.h"
+#include "BitBatch.h"
+#include "BitError.h"
+#include "BitReader.h"
+#include "BitWriter.h"
+#include "BitMappedFile.h"
+#include "BitProfile.h"
+#include "BitBenchmark.h"
+#include "BitCompiled.h"
+#include "BitLiveProgram.h"
+#include "BitServer.h"
+#include "BitTrace.h"
+#include "BitSamples.h"
 
 using namespace std;
 
 /// <summary>
 /// This is a interpreter for the esotheric programming language "BIT".
 /// http://www.dangermouse.net/esoteric/bit.html
-/// This is the languages grammar:
-/// <![CDATA[
-///
-/// <code>         ::= <line> [ <line> ]...
-/// <line>         ::= "LINE NUMBER" <bits> "CODE" <instruction> [ <goto> ]
-/// <instruction>  ::= <command>
-///                  | <assignment>
-/// <goto>         ::= "GOTO" [ "VARIABLE" ] <bits> [ "IF THE JUMP REGISTER IS" [ "EQUAL TO" ] <bit>
-///                  [ "GOTO" [ "VARIABLE" ] <bits> "IF THE JUMP REGISTER IS" [ "EQUAL TO" ] <bit> ] ]
-///
-/// <command>      ::= "PRINT" <bit>
-///                  | "READ"
-/// <assignment>   ::= (<variable> | <expression>) "EQUALS" <expression>
-///
-/// <expression>   ::= <expression2> [ "NAND" <expression2> ]
-/// <expression2>  ::= [ "THE ADDRESS OF" ] <expression3>
-/// <expression3>  ::= [ "THE VALUE BEYOND" ] <expression4>
-/// <expression4>  ::= [ "THE VALUE AT" ] <expression5>
-/// <expression5>  ::= <variable>
-///                  | <bits>
-///                  | "OPEN PARENTHESIS" <expression> "CLOSE PARENTHESIS"
-///
-/// <variable>     ::= "VARIABLE" <bits>
-///                  | "THE JUMP REGISTER"
-///
-/// <bits>         ::= <bit> [ <bit> ]...
-/// <bit>          ::= "ZERO"
-///                  | "ONE"
-///
-/// ]]>
+/// The grammar of the language is described in BitParser.h.
 /// </summary>
 
-#pragma region Types
+// The trace of a program is written to the file when it fails, or after every program with trace_always.
+const char* trace_path = NULL;
+bool trace_always = false;
+// The metrics of the interpreter are written to the file when the programs ended, or after every run when watching.
+const char* metrics_path = NULL;
 
-enum ValueType {
-	UNDEFINED = 0,
-	BIT = 1,
-	ADDRESS_OF_A_BIT = 2
-};
-
-struct Value {
-	int value;
-	ValueType type;
-};
-
-#pragma endregion
-
-#pragma region Declarations
-
-class LineNode;
-class InstructionNode;
-class CommandNode;
-class AssignmentNode;
-class GotoNode;
-class ExpressionNode;
-class Expression1Node;
-class Expression2Node;
-class Expression3Node;
-class Expression4Node;
-class Expression5Node;
-class VariableNode;
-
-class Node {
-};
-
-class CodeNode : public Node {
-public:
-	map<int, LineNode> lines;
-	int first_line_number;
-
-	CodeNode() : first_line_number(-1) {};
-	void run();
-};
-
-class LineNode : public Node {
-public:
-	int line_number;
-	InstructionNode* instruction;
-	GotoNode* go;
-
-	LineNode() : line_number(-1), instruction(NULL), go(NULL) {};
-	~LineNode() { delete instruction; delete go; };
-	int get_next_line_number();
-};
-
-class InstructionNode : public Node {
-public:
-	virtual void run() = 0;
-};
-
-class CommandNode : public InstructionNode {
-public:
-	int print_value;
-
-	CommandNode() : print_value(-1) {};
-	void run();
-};
-
-class AssignmentNode : public InstructionNode {
-public:
-	int address;
-	ExpressionNode* address_expression;
-	ExpressionNode* expression;
-
-	AssignmentNode() : address(INT_MIN), address_expression(NULL), expression(NULL) {};
-	~AssignmentNode() { delete address_expression, delete expression; };
-	void run();
-};
-
-class GotoNode : public Node {
-public:
-	Value next;
-	int next_if_zero;
-	int next_if_one;
-
-	GotoNode() : next({ -1, BIT }), next_if_zero(-1), next_if_one(-1) {};
-	int next_line_number();
-};
-
-class ExpressionNode : public Node {
-public:
-	virtual Value value() = 0;
-};
-
-class Expression1Node : public ExpressionNode {
-public:
-	ExpressionNode* left;
-	ExpressionNode* right;
-
-	Expression1Node() : left(NULL), right(NULL) {};
-	~Expression1Node() { delete left; delete right; };
-	Value value();
-};
-
-class Expression2Node : public ExpressionNode {
-public:
-	ExpressionNode* child;
-
-	Expression2Node() : child(NULL) {};
-	~Expression2Node() { delete child; };
-	Value value();
-};
-
-class Expression3Node : public ExpressionNode {
-public:
-	ExpressionNode* child;
-
-	Expression3Node() : child(NULL) {};
-	~Expression3Node() { delete child; };
-	Value value();
-};
-
-class Expression4Node : public ExpressionNode {
-public:
-	ExpressionNode* child;
-
-	Expression4Node() : child(NULL) {};
-	~Expression4Node() { delete child; };
-	Value value();
-};
-
-class Expression5Node : public ExpressionNode {
-public:
-	int constant;
-
-	Expression5Node() : constant(0) {};
-	Value value();
-};
-
-class VariableNode : public ExpressionNode {
-public:
-	int address;
-
-	Value value();
-};
-
-Value memory_read(int address);
-void memory_write(int address, Value value);
-void print_bit(int value);
-int read_bit();
-void show_parser_error(string message);
-void show_runtime_error(string message);
-
-CodeNode* parse_code();
-LineNode* parse_line();
-InstructionNode* parse_instruction();
-InstructionNode* parse_command();
-InstructionNode* parse_assignment();
-GotoNode* parse_goto();
-ExpressionNode* parse_expression();
-ExpressionNode* parse_expression2();
-ExpressionNode* parse_expression3();
-ExpressionNode* parse_expression4();
-ExpressionNode* parse_expression5();
-VariableNode* parse_variable();
-int parse_bits();
-int parse_bit();
-
-#pragma endregion
-
-#pragma region Variables
-
-static const int jump_register_address = -1;
-static const bool print_ascii = false;
-
-list<int> input_buffer;
-list<int> output_buffer;
-
-int jump_register;
-map<int, Value> memory;
-
-string* input = NULL;
-int position = 0;
-int length = 0;
-
-#pragma endregion
-
-#pragma region Implementations
-
-void CodeNode::run() {
-	LineNode* line = &lines.at(first_line_number);
-	line->instruction->run();
-	if (line->go != NULL) {
-		int next_line_number = line->go->next_line_number();
-		while (next_line_number >= 0) {
-			if (lines.count(next_line_number) == 0) {
-				show_runtime_error("No line exists with number " + to_string(next_line_number) + ".");
-			}
-			line = &lines.at(next_line_number);
-			line->instruction->run();
-			if (line->go == NULL) {
-				break;
-			}
-			next_line_number = line->go->next_line_number();
-		}
-	}
+void print_parser_error(const BitParserError& error) {
+	cout << "ERROR: " << error.what() << ". Position " << error.position << "\n";
+	cout << "  " << error.excerpt << "\n";
+	cout << "  " << string(error.excerpt_position, ' ') << "^" << "\n";
 }
 
-void CommandNode::run() {
-	if (print_value == 0 || print_value == 1) {
-		print_bit(print_value);
+void save_trace(const BitInterpreter& interpreter, const CodeNode& code) {
+	if (interpreter.trace == NULL) {
+		return;
 	}
-	else {
-		memory_write(jump_register_address, { read_bit(), BIT });
+	if (!interpreter.trace->save(trace_path, code)) {
+		cerr << "The trace can't be written to " << trace_path << ".\n";
+		return;
 	}
+	cerr << "The trace of the last " << min(interpreter.trace->size(), (uint64_t)interpreter.trace->capacity()) << " lines was written to " << trace_path << ".\n";
 }
 
-void AssignmentNode::run() {
-	if (address >= jump_register_address) {
-		memory_write(address, expression->value());
+void save_metrics(const BitInterpreter& interpreter) {
+	if (metrics_path == NULL) {
+		return;
 	}
-	else {
-		memory_write(address_expression->value().value, expression->value());
+	ofstream file(metrics_path, ios::trunc);
+	interpreter.metrics.write_prometheus(file);
+	if (!file) {
+		cerr << "The metrics can't be written to " << metrics_path << ".\n";
 	}
 }
 
-int GotoNode::next_line_number() {
-	if (next.value > -1) {
-		if (next.type == ADDRESS_OF_A_BIT) {
-			return memory_read(next.value).value;
-		}
-		return next.value;
-	}
-	if (next_if_zero > -1 && jump_register == 0) {
-		return next_if_zero;
-	}
-	if (next_if_one > -1 && jump_register == 1) {
-		return next_if_one;
+// Prints a trace file, with the text of its lines if the source is given.
+int decode_trace(const char* path, const char* source_path) {
+	ifstream file(path, ios::binary);
+	string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	BitTrace::Decoded trace;
+	if (!file || !trace.load(data.data(), data.data() + data.size())) {
+		cout << "ERROR: The trace file " << path << " can't be read.\n";
+		return 1;
 	}
-	return -1;
-}
-
-Value Expression1Node::value() {
-	Value value_left = left->value();
-	if (right != NULL) {
-		Value value_right = right->value();
-		if (value_left.value == ADDRESS_OF_A_BIT || value_right.value == ADDRESS_OF_A_BIT) {
-			show_runtime_error("The NAND operator requires bit values.");
+	string source;
+	if (source_path != NULL) {
+		ifstream source_file(source_path, ios::binary);
+		if (!source_file) {
+			cout << "ERROR: The file " << source_path << " can't be opened.\n";
+			return 1;
 		}
-		return{ ~(value_left.value & value_right.value), BIT };
+		source.assign((istreambuf_iterator<char>(source_file)), istreambuf_iterator<char>());
 	}
-	return value_left;
+	trace.write_text(cout, source_path != NULL ? &source : NULL);
+	return 0;
 }
 
-Value Expression2Node::value() {
-	Value value = child->value();
-	if (value.value == ADDRESS_OF_A_BIT) {
-		show_runtime_error("The THE ADDRESS OF operator requires a bit value.");
-	}
-	if (value.value < jump_register_address) {
-		show_runtime_error("Invalid memory address: " + to_string(value.value) + ".");
-	}
-	if (value.value == jump_register_address) {
-		show_runtime_error("The THE ADDRESS OF operator can't be used with the jump register.");
+// Runs the programs returned by next until it returns NULL, errors are printed and end the run.
+// With profiles every program is profiled, also if it fails.
+template<class Next>
+int run_programs(Next next, BitInterpreter& interpreter, BitWriter& output, vector<unique_ptr<BitProfile>>* profiles) {
+	try {
+		for (;;) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			CodeNode* code = next();
+			if (code == NULL) {
+				break;
+			}
+			BitProgram program(code, interpreter.options);
+			interpreter.metrics.parses++;
+			interpreter.metrics.parse_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			if (profiles != NULL) {
+				profiles->emplace_back(new BitProfile(*program.code));
+				interpreter.profile = profiles->back().get();
+			}
+			try {
+				interpreter.run(program);
+			}
+			catch (const BitError&) {
+				save_trace(interpreter, *program.code);
+				throw;
+			}
+			if (trace_always) {
+				save_trace(interpreter, *program.code);
+			}
+			output.put('\n');
+			output.flush();
+		}
 	}
-	return{ value.value, ADDRESS_OF_A_BIT };
-}
-
-Value Expression3Node::value() {
-	Value value = child->value();
-	if (value.value == BIT) {
-		show_runtime_error("The THE VALUE BEYOND operator requires an address-of-a-bit value.");
+	catch (const BitParserError& error) {
+		output.flush();
+		print_parser_error(error);
+		return 1;
 	}
-	if (value.value < 0) {
-		show_runtime_error("Invalid memory address: " + to_string(value.value) + ".");
+	catch (const BitLimitError& error) {
+		output.flush();
+		cout << "STOPPED: " << error.what() << "\n";
+		return 2;
 	}
-	Value result = memory_read(value.value + 1);
-	if (result.value == ADDRESS_OF_A_BIT) {
-		show_runtime_error("Variable must contain a bit value.");
+	catch (const BitError& error) {
+		output.flush();
+		cout << "RUNTIME ERROR: " << error.what() << "\n";
+		return 1;
 	}
-	return result;
+	return 0;
 }
 
-Value Expression4Node::value() {
-	Value value = child->value();
-	if (value.value == BIT) {
-		show_runtime_error("The THE VALUE BEYOND operator requires an address-of-a-bit value.");
-	}
-	if (value.value < 0) {
-		show_runtime_error("Invalid memory address: " + to_string(value.value) + ".");
-	}
-	Value result = memory_read(value.value);
-	if (result.value == ADDRESS_OF_A_BIT) {
-		show_runtime_error("Variable must contain a bit value.");
-	}
-	return result;
+// Runs every program of the source, each one is parsed when the one before it ended.
+int run_source(BitReader& source, BitInterpreter& interpreter, BitWriter& output, vector<unique_ptr<BitProfile>>* profiles) {
+	BitParser parser(source);
+	bool optimize = interpreter.options.optimize;
+	return run_programs([&]() -> CodeNode* {
+		return !parser.at_end() ? parser.parse(optimize) : NULL;
+	}, interpreter, output, profiles);
 }
 
-Value Expression5Node::value() {
-	return{ constant, UNDEFINED };
+int run_compiled(vector<unique_ptr<CodeNode>>& programs, BitInterpreter& interpreter, BitWriter& output, vector<unique_ptr<BitProfile>>* profiles) {
+	size_t next = 0;
+	return run_programs([&]() -> CodeNode* {
+		return next < programs.size() ? programs[next++].release() : NULL;
+	}, interpreter, output, profiles);
 }
 
-Value VariableNode::value() {
-	if (address >= jump_register_address) {
-		return memory_read(address);
+// Parses all programs of the source at once and adds them to compiled.
+void parse_programs(BitReader& source, bool optimize, BitCompiled& compiled, vector<unique_ptr<CodeNode>>& programs) {
+	BitParser parser(source);
+	while (!parser.at_end()) {
+		programs.emplace_back(parser.parse(optimize));
+		compiled.add(*programs.back());
 	}
-	show_runtime_error("Illegal address: " + to_string(address) + ".");
 }
 
-#pragma endregion
-
-#pragma region Inputs
-
-string helloworld = "LINENUMBERZEROCODEPRINTZEROGOTOONELINENUMBERONECODEPRINTONEGOTOONEZEROLINENUMBERONEZEROCODEPRINTZEROGOTOONEONELINENUMBERONEONECODEPRINTZEROGOTOONEZEROZEROLINENUMBERONEZEROZEROCODEPRINTONEGOTOONEZEROONELINENUMBERONEZEROONECODEPRINTZEROGOTOONEONEZEROLINENUMBERONEONEZEROCODEPRINTZEROGOTOONEONEONELINENUMBERONEONEONECODEPRINTZEROGOTOONEZEROZEROZEROLINENUMBERONEZEROZEROZEROCODEPRINTZEROGOTOONEZEROZEROONELINENUMBERONEZEROZEROONECODEPRINTONEGOTOONEZEROONEZEROLINENUMBERONEZEROONEZEROCODEPRINTONEGOTOONEZEROONEONELINENUMBERONEZEROONEONECODEPRINTZEROGOTOONEONEZEROZEROLINENUMBERONEONEZEROZEROCODEPRINTZEROGOTOONEONEZEROONELINENUMBERONEONEZEROONECODEPRINTONEGOTOONEONEONEZEROLINENUMBERONEONEONEZEROCODEPRINTZEROGOTOONEONEONEONELINENUMBERONEONEONEONECODEPRINTONEGOTOONEZEROZEROZEROZEROLINENUMBERONEZEROZEROZEROZEROCODEPRINTZEROGOTOONEZEROZEROZEROONELINENUMBERONEZEROZEROZEROONECODEPRINTONEGOTOONEZEROZEROONEZEROLINENUMBERONEZEROZEROONEZEROCODEPRINTONEGOTOONEZEROZEROONEONELINENUMBERONEZEROZEROONEONECODEPRINTZEROGOTOONEZEROONEZEROZEROLINENUMBERONEZEROONEZEROZEROCODEPRINTONEGOTOONEZEROONEZEROONELINENUMBERONEZEROONEZEROONECODEPRINTONEGOTOONEZEROONEONEZEROLINENUMBERONEZEROONEONEZEROCODEPRINTZEROGOTOONEZEROONEONEONELINENUMBERONEZEROONEONEONECODEPRINTZEROGOTOONEONEZEROZEROZEROLINENUMBERONEONEZEROZEROZEROCODEPRINTZEROGOTOONEONEZEROZEROONELINENUMBERONEONEZEROZEROONECODEPRINTONEGOTOONEONEZEROONEZEROLINENUMBERONEONEZEROONEZEROCODEPRINTONEGOTOONEONEZEROONEONELINENUMBERONEONEZEROONEONECODEPRINTZEROGOTOONEONEONEZEROZEROLINENUMBERONEONEONEZEROZEROCODEPRINTONEGOTOONEONEONEZEROONELINENUMBERONEONEONEZEROONECODEPRINTONEGOTOONEONEONEONEZEROLINENUMBERONEONEONEONEZEROCODEPRINTZEROGOTOONEONEONEONEONELINENUMBERONEONEONEONEONECODEPRINTZEROGOTOONEZEROZEROZEROZEROZEROLINENUMBERONEZEROZEROZEROZEROZEROCODEPRINTZEROGOTOONEZEROZEROZEROZEROONELINENUMBERONEZEROZEROZEROZEROONECODEPRINTONEGOTOONEZEROZEROZEROONEZEROLINENUMBERONEZEROZEROZEROONEZEROCODEPRINTONEGOTOONEZEROZEROZEROONEONELINENUMBERONEZEROZEROZEROONEONECODEPRINTZEROGOTOONEZEROZEROONEZEROZEROLINENUMBERONEZEROZEROONEZEROZEROCODEPRINTONEGOTOONEZEROZEROONEZEROONELINENUMBERONEZEROZEROONEZEROONECODEPRINTONEGOTOONEZEROZEROONEONEZEROLINENUMBERONEZEROZEROONEONEZEROCODEPRINTONEGOTOONEZEROZEROONEONEONELINENUMBERONEZEROZEROONEONEONECODEPRINTONEGOTOONEZEROONEZEROZEROZEROLINENUMBERONEZEROONEZEROZEROZEROCODEPRINTZEROGOTOONEZEROONEZEROZEROONELINENUMBERONEZEROONEZEROZEROONECODEPRINTZEROGOTOONEZEROONEZEROONEZEROLINENUMBERONEZEROONEZEROONEZEROCODEPRINTONEGOTOONEZEROONEZEROONEONELINENUMBERONEZEROONEZEROONEONECODEPRINTZEROGOTOONEZEROONEONEZEROZEROLINENUMBERONEZEROONEONEZEROZEROCODEPRINTZEROGOTOONEZEROONEONEZEROONELINENUMBERONEZEROONEONEZEROONECODEPRINTZEROGOTOONEZEROONEONEONEZEROLINENUMBERONEZEROONEONEONEZEROCODEPRINTZEROGOTOONEZEROONEONEONEONELINENUMBERONEZEROONEONEONEONECODEPRINTZEROGOTOONEONEZEROZEROZEROZEROLINENUMBERONEONEZEROZEROZEROZEROCODEPRINTZEROGOTOONEONEZEROZEROZEROONELINENUMBERONEONEZEROZEROZEROONECODEPRINTONEGOTOONEONEZEROZEROONEZEROLINENUMBERONEONEZEROZEROONEZEROCODEPRINTONEGOTOONEONEZEROZEROONEONELINENUMBERONEONEZEROZEROONEONECODEPRINTONEGOTOONEONEZEROONEZEROZEROLINENUMBERONEONEZEROONEZEROZEROCODEPRINTZEROGOTOONEONEZEROONEZEROONELINENUMBERONEONEZEROONEZEROONECODEPRINTONEGOTOONEONEZEROONEONEZEROLINENUMBERONEONEZEROONEONEZEROCODEPRINTONEGOTOONEONEZEROONEONEONELINENUMBERONEONEZEROONEONEONECODEPRINTONEGOTOONEONEONEZEROZEROZEROLINENUMBERONEONEONEZEROZEROZEROCODEPRINTZEROGOTOONEONEONEZEROZEROONELINENUMBERONEONEONEZEROZEROONECODEPRINTONEGOTOONEONEONEZEROONEZEROLINENUMBERONEONEONEZEROONEZEROCODEPRINTONEGOTOONEONEONEZEROONEONELINENUMBERONEONEONEZEROONEONECODEPRINTZEROGOTOONEONEONEONEZEROZEROLINENUMBERONEONEONEONEZEROZEROCODEPRINTONEGOTOONEONEONEONEZEROONELINENUMBERONEONEONEONEZEROONECODEPRINTONEGOTOONEONEONEONEONEZEROLINENUMBERONEONEONEONEONEZEROCODEPRINTONEGOTOONEONEONEONEONEONELINENUMBERONEONEONEONEONEONECODEPRINTONEGOTOONEZEROZEROZEROZEROZEROZEROLINENUMBERONEZEROZEROZEROZEROZEROZEROCODEPRINTZEROGOTOONEZEROZEROZEROZEROZEROONELINENUMBERONEZEROZEROZEROZEROZEROONECODEPRINTONEGOTOONEZEROZEROZEROZEROONEZEROLINENUMBERONEZEROZEROZEROZEROONEZEROCODEPRINTONEGOTOONEZEROZEROZEROZEROONEONELINENUMBERONEZEROZEROZEROZEROONEONECODEPRINTONEGOTOONEZEROZEROZEROONEZEROZEROLINENUMBERONEZEROZEROZEROONEZEROZEROCODEPRINTZEROGOTOONEZEROZEROZEROONEZEROONELINENUMBERONEZEROZEROZEROONEZEROONECODEPRINTZEROGOTOONEZEROZEROZEROONEONEZEROLINENUMBERONEZEROZEROZEROONEONEZEROCODEPRINTONEGOTOONEZEROZEROZEROONEONEONELINENUMBERONEZEROZEROZEROONEONEONECODEPRINTZEROGOTOONEZEROZEROONEZEROZEROZEROLINENUMBERONEZEROZEROONEZEROZEROZEROCODEPRINTZEROGOTOONEZEROZEROONEZEROZEROONELINENUMBERONEZEROZEROONEZEROZEROONECODEPRINTONEGOTOONEZEROZEROONEZEROONEZEROLINENUMBERONEZEROZEROONEZEROONEZEROCODEPRINTONEGOTOONEZEROZEROONEZEROONEONELINENUMBERONEZEROZEROONEZEROONEONECODEPRINTZEROGOTOONEZEROZEROONEONEZEROZEROLINENUMBERONEZEROZEROONEONEZEROZEROCODEPRINTONEGOTOONEZEROZEROONEONEZEROONELINENUMBERONEZEROZEROONEONEZEROONECODEPRINTONEGOTOONEZEROZEROONEONEONEZEROLINENUMBERONEZEROZEROONEONEONEZEROCODEPRINTZEROGOTOONEZEROZEROONEONEONEONELINENUMBERONEZEROZEROONEONEONEONECODEPRINTZEROGOTOONEZEROONEZEROZEROZEROZEROLINENUMBERONEZEROONEZEROZEROZEROZEROCODEPRINTZEROGOTOONEZEROONEZEROZEROZEROONELINENUMBERONEZEROONEZEROZEROZEROONECODEPRINTONEGOTOONEZEROONEZEROZEROONEZEROLINENUMBERONEZEROONEZEROZEROONEZEROCODEPRINTONEGOTOONEZEROONEZEROZEROONEONELINENUMBERONEZEROONEZEROZEROONEONECODEPRINTZEROGOTOONEZEROONEZEROONEZEROZEROLINENUMBERONEZEROONEZEROONEZEROZEROCODEPRINTZEROGOTOONEZEROONEZEROONEZEROONELINENUMBERONEZEROONEZEROONEZEROONECODEPRINTONEGOTOONEZEROONEZEROONEONEZEROLINENUMBERONEZEROONEZEROONEONEZEROCODEPRINTZEROGOTOONEZEROONEZEROONEONEONELINENUMBERONEZEROONEZEROONEONEONECODEPRINTZEROGOTOONEZEROONEONEZEROZEROZEROLINENUMBERONEZEROONEONEZEROZEROZEROCODEPRINTZEROGOTOONEZEROONEONEZEROZEROONELINENUMBERONEZEROONEONEZEROZEROONECODEPRINTZEROGOTOONEZEROONEONEZEROONEZEROLINENUMBERONEZEROONEONEZEROONEZEROCODEPRINTONEGOTOONEZEROONEONEZEROONEONELINENUMBERONEZEROONEONEZEROONEONECODEPRINTZEROGOTOONEZEROONEONEONEZEROZEROLINENUMBERONEZEROONEONEONEZEROZEROCODEPRINTZEROGOTOONEZEROONEONEONEZEROONELINENUMBERONEZEROONEONEONEZEROONECODEPRINTZEROGOTOONEZEROONEONEONEONEZEROLINENUMBERONEZEROONEONEONEONEZEROCODEPRINTZEROGOTOONEZEROONEONEONEONEONELINENUMBERONEZEROONEONEONEONEONECODEPRINTONE";
-string helloworldshort = "LINE NUMBER ZERO CODE PRINT ZERO GOTO ONE ONE ZERO ONE  LINE NUMBER ONE CODE PRINT ZERO GOTO ONE ZERO  LINE NUMBER ONE ONE CODE PRINT ZERO GOTO ONE ZERO ZERO ONE ZERO  LINE NUMBER ONE ZERO CODE PRINT ONE GOTO ONE ONE  LINE NUMBER ONE ONE ONE CODE PRINT ONE GOTO ONE ZERO ONE  LINE NUMBER ONE ZERO ONE CODE PRINT ZERO GOTO ONE ONE ZERO  LINE NUMBER ONE ONE ZERO CODE PRINT ONE GOTO ONE ZERO ZERO  LINE NUMBER ONE ZERO ZERO CODE PRINT ONE GOTO ONE ONE ONE ONE  LINE NUMBER ONE ONE ONE ONE CODE PRINT ZERO GOTO ONE ZERO ONE ONE  LINE NUMBER ONE ZERO ONE ONE CODE PRINT ZERO GOTO VARIABLE ONE  LINE NUMBER ONE ONE ZERO ONE CODE PRINT ONE GOTO ONE ONE ONE ZERO  LINE NUMBER ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ZERO ZERO ONE  LINE NUMBER ONE ZERO ZERO ONE CODE PRINT ZERO GOTO ONE ZERO ONE ZERO  LINE NUMBER ONE ZERO ONE ZERO CODE PRINT ONE GOTO ONE ONE ZERO ZERO  LINE NUMBER ONE ONE ZERO ZERO CODE PRINT ZERO GOTO ONE ZERO ZERO ZERO  LINE NUMBER ONE ZERO ZERO ZERO CODE PRINT ZERO GOTO ONE ONE ONE ONE ONE  LINE NUMBER ONE ONE ONE ONE ONE CODE PRINT ZERO GOTO ONE ZERO ONE ONE ONE  LINE NUMBER ONE ZERO ONE ONE ONE CODE PRINT ZERO GOTO ONE ONE ZERO ONE ONE  LINE NUMBER ONE ONE ZERO ONE ONE CODE PRINT ONE GOTO ONE ONE ONE ZERO ONE  LINE NUMBER ONE ONE ONE ZERO ONE CODE PRINT ONE GOTO ONE ONE ONE ONE ZERO  LINE NUMBER ONE ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ZERO ZERO ONE ONE  LINE NUMBER ONE ZERO ZERO ONE ONE CODE PRINT ZERO GOTO ONE ZERO ONE ZERO ONE  LINE NUMBER ONE ZERO ONE ZERO ONE CODE PRINT ONE GOTO ONE ZERO ONE ONE ZERO  LINE NUMBER ONE ZERO ONE ONE ZERO CODE PRINT ZERO GOTO ONE ONE ZERO ZERO ONE  LINE NUMBER ONE ONE ZERO ZERO ONE CODE PRINT ONE GOTO ONE ONE ZERO ONE ZERO  LINE NUMBER ONE ONE ZERO ONE ZERO CODE VARIABLE ONE EQUALS ONE ONE ONEZERO ZERO GOTO ONE  LINE NUMBER ONE ONE ONE ZERO ZERO CODE VARIABLE ONE EQUALS ONE ZEROZERO ZERO ONE GOTO ONE  LINE NUMBER ONE ZERO ZERO ZERO ONE CODE VARIABLE ONE EQUALS ONE ONEONE ONE ZERO ONE GOTO ONE ONE  LINE NUMBER ONE ZERO ZERO ONE ZERO CODE PRINT ONE GOTO ONE ZERO ONE ZERO ZERO  LINE NUMBER ONE ZERO ONE ZERO ZERO CODE PRINT ONE GOTO ONE ONE ZERO ZERO ZERO  LINE NUMBER ONE ONE ZERO ZERO ZERO CODE PRINT ZERO GOTO ONE ZERO ZERO ZERO ZERO  LINE NUMBER ONE ZERO ZERO ZERO ZERO CODE PRINT ONE GOTO ONE ONE ONE ONE ONE ONE  LINE NUMBER ONE ONE ONE ONE ONE ONE CODE PRINT ONE GOTO ONE ZERO ONE ONE ONE ONE  LINE NUMBER ONE ZERO ONE ONE ONE ONE CODE PRINT ONE GOTO ONE ONE ZEROONE ONE ONE  LINE NUMBER ONE ONE ZERO ONE ONE ONE CODE PRINT ONE GOTO ONE ONE ONEZERO ONE ONE  LINE NUMBER ONE ONE ONE ZERO ONE ONE CODE PRINT ZERO GOTO VARIABLE ONE  LINE NUMBER ONE ONE ONE ONE ZERO ONE CODE PRINT ZERO GOTO ONE ONE ONEONE ONE ZERO  LINE NUMBER ONE ONE ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ZEROZERO ONE ONE ONE  LINE NUMBER ONE ZERO ZERO ONE ONE ONE CODE PRINT ONE GOTO ONE ZERO ONEZERO ONE ONE  LINE NUMBER ONE ZERO ONE ZERO ONE ONE CODE PRINT ZERO GOTO ONE ZEROONE ONE ZERO ONE  LINE NUMBER ONE ZERO ONE ONE ZERO ONE CODE PRINT ZERO GOTO ONE ZEROONE ONE ONE ZERO  LINE NUMBER ONE ZERO ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ONEZERO ZERO ONE ONE  LINE NUMBER ONE ONE ZERO ZERO ONE ONE CODE PRINT ZERO GOTO ONE ONEZERO ONE ZERO ONE  LINE NUMBER ONE ONE ZERO ONE ZERO ONE CODE PRINT ZERO GOTO ONE ONEZERO ONE ONE ZERO  LINE NUMBER ONE ONE ZERO ONE ONE ZERO CODE PRINT ZERO GOTO ONE ONE ONEZERO ZERO ONE  LINE NUMBER ONE ONE ONE ZERO ZERO ONE CODE PRINT ONE GOTO ONE ONE ONEZERO ONE ZERO  LINE NUMBER ONE ONE ONE ZERO ONE ZERO CODE PRINT ONE GOTO ONE ONE ONEONE ZERO ZERO  LINE NUMBER ONE ONE ONE ONE ZERO ZERO CODE PRINT ONE GOTO ONE ZEROZERO ZERO ONE ONE  LINE NUMBER ONE ZERO ZERO ZERO ONE ONE CODE PRINT ZERO GOTO ONE ZEROZERO ONE ZERO ONE  LINE NUMBER ONE ZERO ZERO ONE ZERO ONE CODE PRINT ONE GOTO ONE ZEROZERO ONE ONE ZERO  LINE NUMBER ONE ZERO ZERO ONE ONE ZERO CODE PRINT ONE GOTO ONE ZEROONE ZERO ZERO ONE  LINE NUMBER ONE ZERO ONE ZERO ZERO ONE CODE PRINT ONE GOTO ONE ZEROONE ZERO ONE ZERO  LINE NUMBER ONE ZERO ONE ZERO ONE ZERO CODE VARIABLE ONE EQUALS ONEZERO ONE ONE ZERO ZERO GOTO ONE ONE  LINE NUMBER ONE ZERO ONE ONE ZERO ZERO CODE PRINT ZERO GOTO ONE ONEZERO ZERO ZERO ONE  LINE NUMBER ONE ONE ZERO ZERO ZERO ONE CODE PRINT ONE GOTO ONE ONEZERO ZERO ONE ZERO  LINE NUMBER ONE ONE ZERO ZERO ONE ZERO CODE PRINT ONE GOTO ONE ONEZERO ONE ZERO ZERO  LINE NUMBER ONE ONE ZERO ONE ZERO ZERO CODE PRINT ONE GOTO ONE ONE ONEZERO ZERO ZERO  LINE NUMBER ONE ONE ONE ZERO ZERO ZERO CODE PRINT ZERO GOTO ONE ZEROZERO ZERO ZERO ONE  LINE NUMBER ONE ZERO ZERO ZERO ZERO ONE CODE PRINT ZERO GOTO ONE ZEROZERO ZERO ONE ZERO  LINE NUMBER ONE ZERO ZERO ZERO ONE ZERO CODE PRINT ONE GOTO ONE ZEROZERO ONE ZERO ZERO  LINE NUMBER ONE ZERO ZERO ONE ZERO ZERO CODE PRINT ZERO GOTO ONE ZEROONE ZERO ZERO ZERO  LINE NUMBER ONE ZERO ONE ZERO ZERO ZERO CODE VARIABLE ONE EQUALS ONEONE ZERO ZERO ZERO ZERO GOTO ONE  LINE NUMBER ONE ONE ZERO ZERO ZERO ZERO CODE PRINT ZERO GOTO ONE ONEONE ONE ONE ONE ONE  LINE NUMBER ONE ONE ONE ONE ONE ONE ONE CODE PRINT ONE GOTO ONE ZEROZERO ZERO ZERO ZERO  LINE NUMBER ONE ZERO ZERO ZERO ZERO ZERO CODE PRINT ONE GOTO ONE ZEROONE ONE ONE ONE ONE  LINE NUMBER ONE ZERO ONE ONE ONE ONE ONE CODE PRINT ZERO GOTO ONE ONEZERO ONE ONE ONE ONE  LINE NUMBER ONE ONE ZERO ONE ONE ONE ONE CODE PRINT ZERO GOTO ONE ONEONE ZERO ONE ONE ONE  LINE NUMBER ONE ONE ONE ZERO ONE ONE ONE CODE PRINT ONE GOTO ONE ONEONE ONE ZERO ONE ONE  LINE NUMBER ONE ONE ONE ONE ZERO ONE ONE CODE PRINT ZERO GOTO ONE ONEONE ONE ONE ZERO ONE  LINE NUMBER ONE ONE ONE ONE ONE ZERO ONE CODE PRINT ZERO GOTO ONE ONEONE ONE ONE ONE ZERO  LINE NUMBER ONE ONE ONE ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ZEROZERO ONE ONE ONE ONE  LINE NUMBER ONE ZERO ZERO ONE ONE ONE ONE CODE PRINT ZERO GOTO ONEZERO ONE ZERO ONE ONE ONE  LINE NUMBER ONE ZERO ONE ZERO ONE ONE ONE CODE PRINT ONE GOTO ONE ZEROONE ONE ZERO ONE ONE  LINE NUMBER ONE ZERO ONE ONE ZERO ONE ONE CODE PRINT ZERO GOTO ONEZERO ONE ONE ONE ZERO ONE  LINE NUMBER ONE ZERO ONE ONE ONE ZERO ONE CODE PRINT ZERO GOTO ONEZERO ONE ONE ONE ONE ZERO  LINE NUMBER ONE ZERO ONE ONE ONE ONE ZERO CODE PRINT ZERO GOTO ONE ONEZERO ZERO ONE ONE ONE  LINE NUMBER ONE ONE ZERO ZERO ONE ONE ONE CODE PRINT ZERO GOTO ONE ONEZERO ONE ZERO ONE ONE  LINE NUMBER ONE ONE ZERO ONE ZERO ONE ONE CODE PRINT ONE";
-string bitaddition = "LINE NUMBER ONE CODE READ GOTO ONE ZERO LINE NUMBER ONE ZERO CODE VARIABLE ZERO EQUALS THE JUMP REGISTER GOTO ONE ONE LINE NUMBER ONE ONE CODE READ GOTO ONE ZERO ZERO LINE NUMBER ONE ZERO ZERO CODE VARIABLE ONE EQUALS THE JUMP REGISTER GOTO ONE ZERO ONE LINE NUMBER ONE ZERO ONE CODE THE JUMP REGISTER EQUALS OPEN PARENTHESIS VARIABLE ZERO NAND VARIABLE ONE CLOSE PARENTHESIS NAND OPEN PARENTHESIS VARIABLE ZERO NAND VARIABLE ONE CLOSE PARENTHESIS GOTO ONE ONE ZERO IF THE JUMP REGISTER IS EQUAL TO ONE GOTO ONE ZERO ZERO ZERO IF THE JUMP REGISTER IS EQUAL TO ZERO LINE NUMBER ONE ONE ZERO CODE PRINT ONE GOTO ONE ONE ONE LINE NUMBER ONE ONE ONE CODE PRINT ZERO LINE NUMBER ONE ZERO ZERO ZERO CODE THE JUMP REGISTER EQUALS OPEN PARENTHESIS VARIABLE ZERO NAND VARIABLE ZERO CLOSE PARENTHESIS NAND OPEN PARENTHESIS VARIABLE ONE NAND VARIABLE ONE CLOSE PARENTHESIS GOTO ONE ZERO ZERO ONE IF THE JUMP REGISTER IS EQUAL TO ZERO GOTO ONE ZERO ONE ZERO IF THE JUMP REGISTER IS EQUAL TO ONE LINE NUMBER ONE ZERO ZERO ONE CODE PRINT ZERO LINE NUMBER ONE ZERO ONE ZERO CODE PRINT ONE";
-string repeatones_original = "LINE NUMBER ZERO CODE VARIABLE ONE EQUALS THE ADDRESS OF VARIABLE ZERO GOTO ONE LINE NUMBER ONE CODE READ GOTO ONE ZERO LINE NUMBER ONE ZERO CODE THE VALUE AT VARIABLE ONE EQUALS THE JUMP REGISTER GOTO ONE ONE IF THE JUMP REGISTER IS ONE GOTO ONE ZERO ZERO IF THE JUMP REGISTER IS ZERO LINE NUMBER ONE ONE CODE VARIABLE ONE EQUALS THE ADDRESS OF THE VALUE BEYOND VARIABLE ONE GOTO ONE LINE NUMBER ONE ZERO ZERO CODE VARIABLE ONE EQUALS THE ADDRESS OF VARIABLE ZERO GOTO ONE ZERO ONE LINE NUMBER ONE ZERO ONE CODE THE JUMP REGISTER EQUALS THE VALUE AT VARIABLE ONE GOTO ONE ONE ZERO IF THE JUMP REGISTER IS ONE GOTO ONE ZERO ZERO ZERO IF THE JUMP REGISTER IS ZERO LINE NUMBER ONE ONE ZERO CODE PRINT ONE GOTO ONE ONE ONE LINE NUMBER ONE ONE ONE CODE VARIABLE ONE EQUALS THE ADDRESS OF THE VALUE BEYOND VARIABLE ONE GOTO ONE ZERO ONE LINE NUMBER ONE ZERO ZERO ZERO CODE PRINT ZERO";
-string repeatones = "LINE NUMBER ZERO CODE VARIABLE ONE EQUALS THE ADDRESS OF VARIABLE ZERO GOTO ONE LINE NUMBER ONE CODE READ GOTO ONE ZERO LINE NUMBER ONE ZERO CODE THE JUMP REGISTER EQUALS THE VALUE AT VARIABLE ONE GOTO ONE ONE IF THE JUMP REGISTER IS ONE GOTO ONE ZERO ZERO IF THE JUMP REGISTER IS ZERO LINE NUMBER ONE ONE CODE VARIABLE ONE EQUALS THE ADDRESS OF THE VALUE BEYOND VARIABLE ONE GOTO ONE LINE NUMBER ONE ZERO ZERO CODE VARIABLE ONE EQUALS THE ADDRESS OF VARIABLE ZERO GOTO ONE ZERO ONE LINE NUMBER ONE ZERO ONE CODE THE JUMP REGISTER EQUALS THE VALUE AT VARIABLE ONE GOTO ONE ONE ZERO IF THE JUMP REGISTER IS ONE GOTO ONE ZERO ZERO ZERO IF THE JUMP REGISTER IS ZERO LINE NUMBER ONE ONE ZERO CODE PRINT ONE GOTO ONE ONE ONE LINE NUMBER ONE ONE ONE CODE VARIABLE ONE EQUALS THE ADDRESS OF THE VALUE BEYOND VARIABLE ONE GOTO ONE ZERO ONE LINE NUMBER ONE ZERO ZERO ZERO CODE PRINT ZERO";
-string number = "ONE ZERO ZERO ONE ZERO";
-
-int readposition = 0;
-int readbuffer[5] = { 1, 0, 1, 1, 1 };
-
-int writeposition = 0;
-int writebuffer[500];
-
-#pragma endregion
-
-#pragma region Helpers
-
-void show_parser_error(string message) {
-	cout << "ERROR: " << message.c_str() << ". Position " << position << "\n";
-	const int preview_length = 60;
-	int from = max(position - preview_length / 2, 0);
-	int to = min(position + preview_length / 2, length);
-	cout << "  " << input->substr(from, to - from) << "\n";
-	cout << "  " << string(position - from, ' ') << "^" << "\n";
-	exit(1);
-}
-
-void show_runtime_error(string message) {
-	cout << "RUNTIME ERROR: " << message.c_str() << "\n";
-	exit(1);
-}
-
-inline char peek() {
-	return input->at(position);
-}
-
-inline int characters_left() {
-	return length - position;
-}
-
-inline bool is_whitespace(char character) {
-	return isspace(character) != 0;
-}
-
-void skip_whitespace() {
-	while (position < length) {
-		if (!is_whitespace(peek())) {
-			return;
+// Runs a source file or a compiled file. With a cache directory a source is loaded from the compiled file
+// of its content if there is one, otherwise the source is parsed and that file is written before it runs.
+int run_file(const char* path, const char* cache_directory, BitInterpreter& interpreter, BitWriter& output, vector<unique_ptr<BitProfile>>* profiles) {
+	// Regular files are mapped into memory and lexed in place, everything else is read through a buffer.
+	BitMappedFile mapped_file;
+	if (mapped_file.open(path)) {
+		vector<unique_ptr<CodeNode>> programs;
+		if (BitCompiled::is_compiled(mapped_file.begin(), mapped_file.end())) {
+			if (!BitCompiled::load(mapped_file.begin(), mapped_file.end(), programs)) {
+				cout << "ERROR: The compiled file " << path << " is damaged or of another version.\n";
+				return 1;
+			}
+			return run_compiled(programs, interpreter, output, profiles);
+		}
+		BitReader mapped_source(mapped_file.begin(), mapped_file.end());
+		if (cache_directory == NULL) {
+			return run_source(mapped_source, interpreter, output, profiles);
+		}
+		string name = BitCompiled::cache_name(mapped_file.begin(), mapped_file.end(), interpreter.options.optimize);
+		string cache_path = (filesystem::path(cache_directory) / name).string();
+		// The name only holds a hash, a cached file compiled from another source is a miss and written again.
+		BitMappedFile cached_file;
+		if (cached_file.open(cache_path.c_str())
+			&& BitCompiled::is_compiled_from(cached_file.begin(), cached_file.end(), mapped_file.begin(), mapped_file.end())
+			&& BitCompiled::load(cached_file.begin(), cached_file.end(), programs)) {
+			return run_compiled(programs, interpreter, output, profiles);
+		}
+		// A source with a syntax error is run without the cache, so the programs before the error run
+		// and the error is printed as usual. A cache that can't be written only costs a parse next time.
+		BitCompiled compiled;
+		compiled.set_source(mapped_file.begin(), mapped_file.end());
+		try {
+			parse_programs(mapped_source, interpreter.options.optimize, compiled, programs);
 		}
-		position++;
+		catch (const BitParserError&) {
+			BitReader source(mapped_file.begin(), mapped_file.end());
+			return run_source(source, interpreter, output, profiles);
+		}
+		error_code error;
+		filesystem::create_directories(cache_directory, error);
+		compiled.save(cache_path);
+		return run_compiled(programs, interpreter, output, profiles);
+	}
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		cout << "ERROR: The file " << path << " can't be opened.\n";
+		return 1;
 	}
+	BitReader file_source(file);
+	int result = run_source(file_source, interpreter, output, profiles);
+	fclose(file);
+	return result;
 }
 
-bool consume(char character) {
-	if (position < length && peek() == character) {
-		position++;
-		return true;
+// Parses every program of the source and writes them to a compiled file instead of running them.
+int compile_source(BitReader& source, bool optimize, const char* compiled_path) {
+	BitCompiled compiled;
+	vector<unique_ptr<CodeNode>> programs;
+	try {
+		parse_programs(source, optimize, compiled, programs);
 	}
-	return false;
-}
-
-void consume(string symbol) {
-	for (char& character : symbol) {
-		skip_whitespace();
-		if (!consume(character)) {
-			show_parser_error("Illegal symbol found. " + symbol + " was expected.");
-		}
+	catch (const BitParserError& error) {
+		print_parser_error(error);
+		return 1;
+	}
+	if (!compiled.save(compiled_path)) {
+		cout << "ERROR: The file " << compiled_path << " can't be written.\n";
+		return 1;
 	}
+	return 0;
 }
 
-bool check(string symbol) {
-	if (position >= length) {
-		return false;
-	}
-	int positionTemp = position;
-	for (char& character : symbol) {
-		while (is_whitespace(input->at(positionTemp))) {
-			positionTemp++;
-			if (positionTemp >= length) {
-				return false;
-			}
+// Prints the profiles to the standard error and writes them to the JSON file, if there is one.
+int write_profiles(const vector<unique_ptr<BitProfile>>& profiles, const char* json_path, int result) {
+	for (size_t i = 0; i < profiles.size(); i++) {
+		cerr << "Profile of program " << i + 1 << "\n\n";
+		profiles[i]->write_text(cerr);
+		cerr << "\n";
+	}
+	if (json_path != NULL) {
+		ofstream json(json_path);
+		if (!json) {
+			cout << "ERROR: The file " << json_path << " can't be opened.\n";
+			return 1;
 		}
-		if (input->at(positionTemp) != character) {
-			return false;
+		json << "[";
+		for (size_t i = 0; i < profiles.size(); i++) {
+			json << (i > 0 ? "," : "");
+			profiles[i]->write_json(json);
 		}
-		positionTemp++;
+		json << "]\n";
 	}
-	return true;
+	return result;
 }
 
-#pragma endregion
-
-#pragma region Symbols
-
-static const string LINE_NUMBER = "LINENUMBER";
-static const string CODE = "CODE";
-static const string GOTO = "GOTO";
-static const string IF_THE_JUMP_REGISTER_IS = "IFTHEJUMPREGISTERIS";
-static const string EQUAL_TO = "EQUALTO";
-static const string PRINT = "PRINT";
-static const string READ = "READ";
-static const string EQUALS = "EQUALS";
-static const string VARIABLE = "VARIABLE";
-static const string THE_JUMP_REGISTER = "THEJUMPREGISTER";
-static const string NAND = "NAND";
-static const string THE_ADDRESS_OF = "THEADDRESSOF";
-static const string THE_VALUE_BEYOND = "THEVALUEBEYOND";
-static const string THE_VALUE_AT = "THEVALUEAT";
-static const string OPEN_PARENTHESIS = "OPENPARENTHESIS";
-static const string CLOSE_PARENTHESIS = "CLOSEPARENTHESIS";
-static const string ZERO = "ZERO";
-static const string ONE = "ONE";
-
-#pragma endregion
-
-#pragma region Interpreter
-
-void print_bit(int value) {
-	if (print_ascii) {
-		output_buffer.push_back(value);
-		if (output_buffer.size() == 8) {
-			int pos = 0;
-			char character = 0;
-			for (list<int>::reverse_iterator rit = output_buffer.rbegin(); rit != output_buffer.rend(); ++rit) {
-				character |= (*rit << pos);
-				++pos;
-			}
-			cout << character;
-			output_buffer.clear();
+// Measures every backend on the embedded and the generated programs.
+int run_benchmark(const BitOptions& options, const char* json_path) {
+	BitBenchmark benchmark(options);
+	for (const BitSample& sample : BitSamples::all()) {
+		benchmark.add(sample.name, sample.source, sample.input);
+	}
+	benchmark.add_generated();
+	benchmark.run();
+	benchmark.write_text(cout);
+	if (json_path != NULL) {
+		ofstream json(json_path);
+		if (!json) {
+			cout << "ERROR: The file " << json_path << " can't be opened.\n";
+			return 1;
 		}
+		benchmark.write_json(json);
 	}
-	else {
-		cout << value;
-	}
-}
-
-int read_bit() {
-	int value;
-	cin >> value;
-	if (value != 0 && value != 1) {
-		show_runtime_error("Invalid value read.");
-	}
-	return value;
+	return 0;
 }
 
-Value memory_read(int address) {
-	if (address == jump_register_address) {
-		return Value{ jump_register, BIT };
-	}
-	else {
-		if (address > jump_register_address) {
-			if (memory.count(address) == 0) {
-				return memory[address] = { 0, UNDEFINED };
-			}
-			else {
-				return memory.at(address);
-			}
+// Runs the source file again whenever it changes, until the interpreter is ended. Only the changed lines
+// are parsed again and every run continues with the memory of the run before.
+int watch_file(const char* path, BitInterpreter& interpreter, BitWriter& output) {
+	BitLiveProgram live(interpreter.options);
+	filesystem::file_time_type modified;
+	uintmax_t size = 0;
+	for (;;) {
+		error_code error;
+		filesystem::file_time_type time = filesystem::last_write_time(path, error);
+		uintmax_t new_size = filesystem::file_size(path, error);
+		if (error || (time == modified && new_size == size)) {
+			this_thread::sleep_for(chrono::milliseconds(200));
+			continue;
 		}
-		else {
-			show_runtime_error("Invalid memory address: " + to_string(address) + ".");
+		modified = time;
+		size = new_size;
+		ifstream file(path, ios::binary);
+		string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		try {
+			int parsed = live.update(text.data(), text.data() + text.size());
+			cerr << "Reloaded " << path << ": " << parsed << " of " << live.program()->code->lines.size() << " lines parsed\n";
+			live.run(interpreter);
+			output.put('\n');
+			output.flush();
+		}
+		catch (const BitParserError& error) {
+			output.flush();
+			print_parser_error(error);
 		}
+		catch (const BitLimitError& error) {
+			output.flush();
+			cout << "STOPPED: " << error.what() << "\n";
+		}
+		catch (const BitError& error) {
+			output.flush();
+			cout << "RUNTIME ERROR: " << error.what() << "\n";
+		}
+		save_metrics(interpreter);
+		cout.flush();
 	}
 }
 
-void memory_write(int address, Value value) {
-	if (value.type == BIT && value.value != 0 && value.value != 1) {
-		show_runtime_error("Illegal value: " + to_string(value.value));
+// Runs the manifest or the directory of sources on all cores.
+int run_batch(const char* path, int thread_count, const BitOptions& options, BitWriter& output) {
+	BitBatch batch(options, thread_count);
+	bool added = filesystem::is_directory(path) ? batch.add_directory(path) : batch.add_manifest(path);
+	if (!added) {
+		cout << "ERROR: The file " << path << " can't be opened.\n";
+		return 1;
 	}
-	if (address == jump_register_address) {
-		if (value.type == ADDRESS_OF_A_BIT) {
-			show_runtime_error("The jump register can't store address-of-a-bit values.");
+	bool succeeded = batch.run();
+	batch.print(output);
+	return succeeded ? 0 : 1;
+}
+
+// The command line of the interpreter. BIT_BATCH_MAIN and BIT_BENCHMARK_MAIN build it as the batch runner and
+// the benchmarks, which start in that mode and take the options of the interpreters.
+#if defined(BIT_BATCH_MAIN)
+const char* usage = "Usage: BitBatchRunner [--tree-walker | --jit] [--no-optimize] [--detect-loops | --fast-forward-loops] [--ascii] [--ascii-input] [--max-steps count] [--time-limit ms] [--bit-sliced] [--threads count] manifest|directory\n";
+#elif defined(BIT_BENCHMARK_MAIN)
+const char* usage = "Usage: BitBenchmarks [--no-optimize] [--detect-loops | --fast-forward-loops] [--max-steps count] [--time-limit ms] [--benchmark-json file]\n";
+#else
+const char* usage = "Usage: BitInterpreter [--tree-walker | --jit] [--no-optimize] [--detect-loops | --fast-forward-loops] [--ascii] [--ascii-input] [--max-steps count] [--time-limit ms] [--trace file [--trace-always]] [--metrics file] [--speculate] [--no-pipeline] [--profile] [--profile-json file] [--cache directory] [--compile output] [file | --decode-trace trace [source] | --watch file | --server [--socket path] | --batch manifest|directory [--bit-sliced] [--threads count] | --benchmark [--benchmark-json file]]\n";
+#endif
+
+int main(int argc, char* argv[]) {
+	BitOptions options;
+	const char* path = NULL;
+	const char* batch_path = NULL;
+	int thread_count = 0;
+	bool profiling = false;
+	const char* profile_path = NULL;
+#ifdef BIT_BENCHMARK_MAIN
+	bool benchmarking = true;
+#else
+	bool benchmarking = false;
+#endif
+	const char* compiled_path = NULL;
+	const char* cache_directory = NULL;
+	const char* benchmark_path = NULL;
+	const char* watch_path = NULL;
+	bool serving = false;
+	bool pipelined = true;
+	const char* decoded_path = NULL;
+	const char* socket_path = NULL;
+	for (int i = 1; i < argc; i++) {
+		string argument = argv[i];
+		if (argument == "--tree-walker") {
+			options.use_tree_walker = true;
 		}
-		jump_register = value.value;
-	}
-	else {
-		if (address > jump_register_address) {
-			memory[address] = value;
+		else if (argument == "--jit") {
+			options.use_jit = true;
+		}
+		else if (argument == "--no-optimize") {
+			options.optimize = false;
+		}
+		else if (argument == "--detect-loops") {
+			options.cycle_mode = CYCLES_ABORTED;
+		}
+		else if (argument == "--fast-forward-loops") {
+			options.cycle_mode = CYCLES_FAST_FORWARDED;
+		}
+		else if (argument == "--ascii") {
+			options.print_ascii = true;
+		}
+		else if (argument == "--ascii-input") {
+			options.read_ascii = true;
+		}
+		else if (argument == "--batch" && i + 1 < argc) {
+			batch_path = argv[++i];
+		}
+		else if (argument == "--bit-sliced") {
+			options.use_bit_slicing = true;
+		}
+		else if (argument == "--max-steps" && i + 1 < argc) {
+			options.max_steps = strtoull(argv[++i], NULL, 10);
+		}
+		else if (argument == "--time-limit" && i + 1 < argc) {
+			options.time_limit = atoi(argv[++i]);
+		}
+		else if (argument == "--threads" && i + 1 < argc) {
+			thread_count = atoi(argv[++i]);
+		}
+		else if (argument == "--profile") {
+			profiling = true;
+		}
+		else if (argument == "--profile-json" && i + 1 < argc) {
+			profiling = true;
+			profile_path = argv[++i];
+		}
+		else if (argument == "--compile" && i + 1 < argc) {
+			compiled_path = argv[++i];
+		}
+		else if (argument == "--cache" && i + 1 < argc) {
+			cache_directory = argv[++i];
+		}
+		else if (argument == "--benchmark") {
+			benchmarking = true;
+		}
+		else if (argument == "--benchmark-json" && i + 1 < argc) {
+			benchmarking = true;
+			benchmark_path = argv[++i];
+		}
+		else if (argument == "--trace" && i + 1 < argc) {
+			options.trace = true;
+			trace_path = argv[++i];
+		}
+		else if (argument == "--metrics" && i + 1 < argc) {
+			options.count_work = true;
+			metrics_path = argv[++i];
+		}
+		else if (argument == "--trace-always") {
+			trace_always = true;
+		}
+		else if (argument == "--decode-trace" && i + 1 < argc) {
+			decoded_path = argv[++i];
+		}
+		else if (argument == "--speculate") {
+			options.speculate = true;
+		}
+		else if (argument == "--no-pipeline") {
+			pipelined = false;
+		}
+		else if (argument == "--server") {
+			serving = true;
+		}
+		else if (argument == "--socket" && i + 1 < argc) {
+			serving = true;
+			socket_path = argv[++i];
+		}
+		else if (argument == "--watch" && i + 1 < argc) {
+			watch_path = argv[++i];
+		}
+		else if (argument[0] != '-' && path == NULL) {
+			path = argv[i];
 		}
 		else {
-			show_runtime_error("Invalid memory address: " + to_string(address) + ".");
+			cout << usage;
+			return 1;
 		}
 	}
-}
-
-void run_code(CodeNode* code) {
-	if (code != NULL) {
-		code->run();
+#ifdef BIT_BATCH_MAIN
+	if (path == NULL) {
+		cout << usage;
+		return 1;
 	}
-}
-
-#pragma endregion
-
-#pragma region Parser
-
-CodeNode* parse(string* toparse) {
-	if (toparse == NULL) {
-		throw exception("Input was null.");
-	}
-	input = toparse;
-	length = toparse->length();
-	position = 0;
-	memory.clear();
-	jump_register = 0;
-	return parse_code();
-}
-
-CodeNode* parse_code() {
-	CodeNode* node = new CodeNode();
-	LineNode* line = parse_line();
-	node->lines[line->line_number] = *line;
-	node->first_line_number = line->line_number;
-	skip_whitespace();
-	while (check(LINE_NUMBER)) {
-		line = parse_line();
-		if (node->lines.count(line->line_number) > 0) {
-			show_parser_error("Line number is " + to_string(line->line_number) + " already defined.");
-		}
-		node->lines[line->line_number] = *line;
-	}
-	return node;
-}
-
-LineNode* parse_line() {
-	LineNode* node = new LineNode();
-	consume(LINE_NUMBER);
-	node->line_number = parse_bits();
-	consume(CODE);
-	node->instruction = parse_instruction();
-	if (check(GOTO)) {
-		node->go = parse_goto();
-	}
-	return node;
-}
-
-InstructionNode* parse_instruction() {
-	skip_whitespace();
-	if (check(PRINT) || check(READ)) {
-		return parse_command();
+	batch_path = path;
+#endif
+	// The standard streams are read ahead and written behind the interpreter on threads of their own.
+	BitReader standard_input(stdin, pipelined);
+	BitWriter standard_output(stdout, pipelined);
+	if (benchmarking) {
+		return run_benchmark(options, benchmark_path);
+	}
+#ifndef BIT_TRACING
+	if (options.trace) {
+		cout << "ERROR: The interpreter was built without tracing.\n";
+		return 1;
 	}
-	return parse_assignment();
-}
-
-InstructionNode* parse_command() {
-	CommandNode* node = new CommandNode();
-	skip_whitespace();
-	if (check(PRINT)) {
-		consume(PRINT);
-		node->print_value = parse_bit();
-		return node;
-	}
-	if (check(READ)) {
-		consume(READ);
-		return node;
-	}
-	show_parser_error("Illegal symbol found. Command was expected.");
-}
-
-InstructionNode* parse_assignment() {
-	AssignmentNode* node = new AssignmentNode();
-	skip_whitespace();
-	if (check(VARIABLE) || check(THE_JUMP_REGISTER)) {
-		VariableNode* temp = parse_variable();
-		node->address = temp->address;
-		delete temp;
-	}
-	else {
-		node->address_expression = parse_expression();
-	}
-	consume(EQUALS);
-	node->expression = parse_expression();
-	return node;
-}
-
-GotoNode* parse_goto() {
-	GotoNode* node = new GotoNode();
-	consume(GOTO);
-	if (check(VARIABLE)) {
-		consume(VARIABLE);
-		// TODO: ist das korrekt?
-		node->next.type == ADDRESS_OF_A_BIT;
-	}
-	int address1 = parse_bits();
-	if (check(IF_THE_JUMP_REGISTER_IS)) {
-		consume(IF_THE_JUMP_REGISTER_IS);
-		if (check(EQUAL_TO)) {
-			consume(EQUAL_TO);
-		}
-		int bit1 = parse_bit();
-		(bit1 == 0) ? (node->next_if_zero = address1) : (node->next_if_one = address1);
-		if (check(GOTO)) {
-			consume(GOTO);
-			int address2 = parse_bits();
-			consume(IF_THE_JUMP_REGISTER_IS);
-			if (check(EQUAL_TO)) {
-				consume(EQUAL_TO);
-			}
-			int bit2 = parse_bit();
-			if (bit1 == bit2) {
-				show_parser_error("Illegal symbol found. Conditional goto with different bit constant was expected.");
-			}
-			(bit2 == 0) ? (node->next_if_zero = address2) : (node->next_if_one = address2);
-		}
-		return node;
+#endif
+	if (decoded_path != NULL) {
+		return decode_trace(decoded_path, path);
 	}
-	node->next.value = address1;
-	return node;
-}
-
-ExpressionNode* parse_expression() {
-	Expression1Node* node = new Expression1Node();
-	skip_whitespace();
-	node->left = parse_expression2();
-	if (check(NAND)) {
-		consume(NAND);
-		node->right = parse_expression2();
-	}
-	return node;
-}
-
-ExpressionNode* parse_expression2() {
-	skip_whitespace();
-	if (check(THE_ADDRESS_OF)) {
-		consume(THE_ADDRESS_OF);
-		Expression2Node* node = new Expression2Node();
-		node->child = parse_expression3();
-		return node;
-	}
-	return parse_expression3();
-}
-
-ExpressionNode* parse_expression3() {
-	skip_whitespace();
-	if (check(THE_VALUE_BEYOND)) {
-		consume(THE_VALUE_BEYOND);
-		Expression3Node* node = new Expression3Node();
-		node->child = parse_expression4();
-		return node;
-	}
-	return parse_expression4();
-}
-
-ExpressionNode* parse_expression4() {
-	skip_whitespace();
-	if (check(THE_VALUE_AT)) {
-		consume(THE_VALUE_AT);
-		Expression4Node* node = new Expression4Node();
-		node->child = parse_expression5();
-		return node;
-	}
-	return parse_expression5();
-}
-
-ExpressionNode* parse_expression5() {
-	skip_whitespace();
-	if (check(VARIABLE) || check(THE_JUMP_REGISTER)) {
-		return parse_variable();
-	}
-	if (check(ZERO) || check(ONE)) {
-		Expression5Node* node = new Expression5Node();
-		node->constant = parse_bits();
-		return node;
-	}
-	if (check(OPEN_PARENTHESIS)) {
-		consume(OPEN_PARENTHESIS);
-		ExpressionNode* node = parse_expression();
-		consume(CLOSE_PARENTHESIS);
-		return node;
-	}
-	show_parser_error("Illegal symbol found. Expression was expected.");
-}
-
-// TODO: hier muss ein Value zurckgegeben werden, nicht ein node
-// TODO: vielleicht den expression node um die funktion address() erweitern, damit auch die adresse falls ntig zur runtime ausgewertet werden kann
-VariableNode* parse_variable() {
-	if (check(VARIABLE)) {
-		consume(VARIABLE);
-		VariableNode* node = new VariableNode();
-		node->address = parse_bits();
-		return node;
-	}
-	if (check(THE_JUMP_REGISTER)) {
-		consume(THE_JUMP_REGISTER);
-		VariableNode* node = new VariableNode();
-		node->address = jump_register_address;
-		return node;
-	}
-	show_parser_error("Illegal symbol found. Variable was expected.");
-}
-
-int parse_bits() {
-	skip_whitespace();
-	int bit = parse_bit();
-	int bits = bit;
-	while (check(ZERO) || check(ONE)) {
-		int bit = parse_bit();
-		bits = (bits << 1) | bit;
-	}
-	return bits;
-}
-
-int parse_bit() {
-	skip_whitespace();
-	if (check(ZERO)) {
-		consume(ZERO);
-		return 0;
-	}
-	if (check(ONE)) {
-		consume(ONE);
+	if (serving) {
+		BitServer server(options);
+		if (socket_path == NULL) {
+			server.serve(stdin, stdout);
+			return 0;
+		}
+		server.listen(socket_path);
+		cout << "ERROR: The socket " << socket_path << " can't be created.\n";
 		return 1;
 	}
-	show_parser_error("Illegal symbol found. Bit constant was expected.");
-}
-
-#pragma endregion
-
-int main() {
-	for (std::string line; std::getline(std::cin, line);) {
-		run_code(parse(&line));
-		cout << "\n";
+	if (batch_path != NULL) {
+		return run_batch(batch_path, thread_count, options, standard_output);
 	}
-	return 0;
+	if (compiled_path != NULL) {
+		if (path == NULL) {
+			return compile_source(standard_input, options.optimize, compiled_path);
+		}
+		FILE* file = fopen(path, "rb");
+		if (file == NULL) {
+			cout << "ERROR: The file " << path << " can't be opened.\n";
+			return 1;
+		}
+		BitReader file_source(file);
+		int result = compile_source(file_source, options.optimize, compiled_path);
+		fclose(file);
+		return result;
+	}
+	// Only the tree walker counts lines and gotos.
+	if (profiling) {
+		options.use_tree_walker = true;
+	}
+	vector<unique_ptr<BitProfile>> profiles;
+	vector<unique_ptr<BitProfile>>* profiled = profiling ? &profiles : NULL;
+	BitInterpreter interpreter(standard_input, standard_output, options);
+	BitTrace trace;
+	if (options.trace) {
+		interpreter.trace = &trace;
+	}
+	if (watch_path != NULL) {
+		return watch_file(watch_path, interpreter, standard_output);
+	}
+	int result = path != NULL ? run_file(path, cache_directory, interpreter, standard_output, profiled)
+		: run_source(standard_input, interpreter, standard_output, profiled);
+	save_metrics(interpreter);
+	return write_profiles(profiles, profile_path, result);
 }
@@ -0,0 +1,520 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BitParser.h"
+#include "BitInterpreter.h"
+#include "BitProgram.h"
+#include "BitNodes.h"
+#include "BitBatch.h"
+#include "BitCompiled.h"
+#include "BitLiveProgram.h"
+#include "BitServer.h"
+#include "BitTrace.h"
+#include "BitBenchmark.h"
+#include "BitSamples.h"
+#include "BitError.h"
+#include "BitReader.h"
+#include "BitWriter.h"
+
+using namespace std;
+
+/// <summary>
+/// The tests of the interpreter, run by ctest one by one: BitTests name runs the test of that name.
+/// The files the tests write are kept in the working directory.
+/// </summary>
+
+#pragma region Helpers
+
+static int failures = 0;
+
+static void check(bool condition, const string& what, const char* file, int line) {
+	if (!condition) {
+		cout << file << ":" << line << ": " << what << "\n";
+		failures++;
+	}
+}
+
+#define CHECK(condition, what) check(condition, what, __FILE__, __LINE__)
+
+struct Backend {
+	const char* name;
+	BitOptions options;
+};
+
+static vector<Backend> backends() {
+	vector<Backend> all(7);
+	all[0].name = "virtual machine";
+	all[1].name = "tree walker";
+	all[1].options.use_tree_walker = true;
+	all[2].name = "jit";
+	all[2].options.use_jit = true;
+	all[3].name = "virtual machine without optimizations";
+	all[3].options.optimize = false;
+	all[4].name = "tree walker without optimizations";
+	all[4].options.use_tree_walker = true;
+	all[4].options.optimize = false;
+	all[5].name = "virtual machine with a step limit";
+	all[5].options.max_steps = 1 << 30;
+	all[6].name = "virtual machine with speculation";
+	all[6].options.speculate = true;
+	return all;
+}
+
+static CodeNode* parse(const string& source, bool optimize) {
+	BitReader reader(source.data(), source.data() + source.size());
+	BitParser parser(reader);
+	return parser.parse(optimize);
+}
+
+// The output of a run followed by its error, if it failed.
+static string run(CodeNode* code, const BitOptions& options, const string& input) {
+	BitProgram program(code, options);
+	BitReader reader(input.data(), input.data() + input.size());
+	string output;
+	BitWriter writer(output);
+	BitInterpreter interpreter(reader, writer, options);
+	string error;
+	try {
+		interpreter.run(program);
+	}
+	catch (const BitError& failure) {
+		error = failure.what();
+	}
+	writer.flush();
+	return error.empty() ? output : output + " ERROR: " + error;
+}
+
+static string run(const string& source, const BitOptions& options, const string& input) {
+	return run(parse(source, options.optimize), options, input);
+}
+
+static bool write_file(const string& path, const string& contents) {
+	ofstream file(path, ios::binary | ios::trunc);
+	return (bool)file.write(contents.data(), contents.size());
+}
+
+static string read_file(const string& path) {
+	ifstream file(path, ios::binary);
+	return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+}
+
+static string compiled_file(const string& source, bool optimize) {
+	unique_ptr<CodeNode> code(parse(source, optimize));
+	BitCompiled compiled;
+	compiled.add(*code);
+	string path = "compiled.bitc";
+	compiled.save(path);
+	return read_file(path);
+}
+
+// The samples and generated programs, with every input of bitaddition.
+static vector<BitSample> programs() {
+	vector<BitSample> all = BitSamples::all();
+	string bitaddition = all[2].source;
+	for (const char* input : { "00", "01", "10" }) {
+		all.push_back({ string("bitaddition ") + input, bitaddition, input });
+	}
+	all.push_back({ "counter", BitBenchmark::counter_program(6), "" });
+	all.push_back({ "straight", BitBenchmark::straight_program(200), "" });
+	all.push_back({ "goto variable", "LINE NUMBER ZERO CODE VARIABLE ZERO EQUALS ONE GOTO VARIABLE ZERO "
+		"LINE NUMBER ONE CODE PRINT ONE", "" });
+	return all;
+}
+
+// A program that stores an address into variable zero, and one that copies variable zero into the jump register.
+static const string address_store = "LINE NUMBER ZERO CODE VARIABLE ZERO EQUALS THE ADDRESS OF VARIABLE ONE";
+static const string jump_register_copy = "LINE NUMBER ZERO CODE THE JUMP REGISTER EQUALS VARIABLE ZERO "
+	"GOTO ONE IF THE JUMP REGISTER IS ONE GOTO ONE ZERO IF THE JUMP REGISTER IS ZERO "
+	"LINE NUMBER ONE CODE PRINT ONE LINE NUMBER ONE ZERO CODE PRINT ZERO";
+static const string address_error = "The jump register can't store address-of-a-bit values.";
+
+// A compiled program whose variable address is -3, below the jump register.
+static string damaged_file() {
+	string data = compiled_file("LINE NUMBER ZERO CODE VARIABLE ONE EQUALS VARIABLE ONE ZERO ONE GOTO ONE "
+		"LINE NUMBER ONE CODE PRINT ONE", false);
+	// The expression is the variable kind followed by the address 5, both zigzag encoded as 10.
+	size_t found = data.find("\x0A\x0A");
+	CHECK(found != string::npos, "the variable expression is found in the compiled file");
+	if (found != string::npos) {
+		data[found + 1] = 0x05;
+	}
+	return data;
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+// Every backend prints the same bits and fails with the same error.
+static void test_backends() {
+	for (const BitSample& sample : programs()) {
+		string expected;
+		for (const Backend& backend : backends()) {
+			string result = run(sample.source, backend.options, sample.input);
+			if (expected.empty()) {
+				expected = result;
+			}
+			CHECK(result == expected, sample.name + " on the " + backend.name + ": " + result + " instead of " + expected);
+		}
+	}
+}
+
+// Bit-sliced batches give the runs of a program the same results as running them one by one.
+static void test_bit_sliced() {
+	BitOptions sliced_options;
+	sliced_options.use_bit_slicing = true;
+	BitBatch sliced(sliced_options, 1);
+	BitBatch single(BitOptions(), 1);
+	vector<BitSample> samples = programs();
+	for (size_t i = 0; i < samples.size(); i++) {
+		string source_path = "sliced" + to_string(i) + ".bit";
+		string input_path = "sliced" + to_string(i) + ".txt";
+		write_file(source_path, samples[i].source);
+		write_file(input_path, samples[i].input);
+		// Every program runs several times, so the lanes of a slice are shared.
+		for (int copy = 0; copy < 3; copy++) {
+			sliced.add(source_path, input_path);
+			single.add(source_path, input_path);
+		}
+	}
+	sliced.run();
+	single.run();
+	string sliced_output;
+	string single_output;
+	BitWriter sliced_writer(sliced_output);
+	BitWriter single_writer(single_output);
+	sliced.print(sliced_writer);
+	single.print(single_writer);
+	CHECK(sliced_output == single_output, "bit-sliced batch:\n" + sliced_output + "instead of\n" + single_output);
+	for (const BitSample& sample : samples) {
+		string result = run(sample.source, BitOptions(), sample.input);
+		CHECK(single_output.find(result.substr(0, result.find(" ERROR: "))) != string::npos, sample.name + " is missing in the batch");
+	}
+}
+
+// Compiled files run like the sources they were compiled from.
+static void test_compiled_round_trip() {
+	for (const BitSample& sample : programs()) {
+		for (bool optimize : { true, false }) {
+			string data = compiled_file(sample.source, optimize);
+			CHECK(BitCompiled::is_compiled(data.data(), data.data() + data.size()), sample.name + " is recognized as compiled");
+			vector<unique_ptr<CodeNode>> loaded;
+			bool ok = BitCompiled::load(data.data(), data.data() + data.size(), loaded);
+			CHECK(ok && loaded.size() == 1, sample.name + " is loaded");
+			if (!ok || loaded.size() != 1) {
+				continue;
+			}
+			for (const Backend& backend : backends()) {
+				string expected = run(sample.source, backend.options, sample.input);
+				string result = run(loaded[0].release(), backend.options, sample.input);
+				loaded.clear();
+				BitCompiled::load(data.data(), data.data() + data.size(), loaded);
+				CHECK(result == expected, sample.name + " compiled on the " + backend.name + ": " + result + " instead of " + expected);
+			}
+		}
+	}
+}
+
+// A cached file is only used for the source it was compiled from, also if the names of two sources collide.
+static void test_compiled_cache() {
+	const string source = "LINE NUMBER ZERO CODE PRINT ONE";
+	const string other = "LINE NUMBER ZERO CODE PRINT TWO";
+	unique_ptr<CodeNode> code(parse(source, true));
+	BitCompiled compiled;
+	compiled.set_source(source.data(), source.data() + source.size());
+	compiled.add(*code);
+	CHECK(compiled.save("cached.bitc"), "the cached file is saved");
+	string data = read_file("cached.bitc");
+	const char* begin = data.data();
+	const char* end = begin + data.size();
+	CHECK(BitCompiled::is_compiled_from(begin, end, source.data(), source.data() + source.size()), "the cached file matches its source");
+	CHECK(!BitCompiled::is_compiled_from(begin, end, other.data(), other.data() + other.size()), "the cached file doesn't match a source of the same size");
+	CHECK(!BitCompiled::is_compiled_from(begin, end, source.data(), source.data() + source.size() - 1), "the cached file doesn't match a prefix of its source");
+	vector<unique_ptr<CodeNode>> loaded;
+	CHECK(BitCompiled::load(begin, end, loaded) && run(loaded[0].release(), BitOptions(), "") == "1", "the cached file runs");
+	string untied = compiled_file(source, true);
+	CHECK(!BitCompiled::is_compiled_from(untied.data(), untied.data() + untied.size(), source.data(), source.data() + source.size()),
+		"a file that isn't tied to a source is no cached file");
+}
+
+// A damaged compiled file is rejected when it is loaded, every program that loads also compiles.
+static void test_damaged_compiled() {
+	string damaged = damaged_file();
+	vector<unique_ptr<CodeNode>> loaded;
+	CHECK(!BitCompiled::load(damaged.data(), damaged.data() + damaged.size(), loaded), "an address below the jump register is rejected");
+	const vector<BitSample>& samples = BitSamples::all();
+	for (const BitSample& sample : { samples[2], samples[3] }) {
+		string data = compiled_file(sample.source, true);
+		for (size_t i = 0; i < data.size(); i++) {
+			for (int replacement : { 0x00, 0x01, 0x05, 0x7F, 0x80, 0xFF, (uint8_t)data[i] ^ 1 }) {
+				string mutated = data;
+				mutated[i] = (char)replacement;
+				loaded.clear();
+				if (!BitCompiled::load(mutated.data(), mutated.data() + mutated.size(), loaded)) {
+					continue;
+				}
+				for (unique_ptr<CodeNode>& code : loaded) {
+					try {
+						BitOptions options;
+						options.max_steps = 10000;
+						run(code.release(), options, sample.input);
+					}
+					catch (const exception& error) {
+						CHECK(false, sample.name + " with byte " + to_string(i) + " changed loads but fails to compile: " + error.what());
+					}
+				}
+			}
+		}
+	}
+}
+
+// A damaged file in a batch is reported as the result of its runs.
+static void test_damaged_batch() {
+	write_file("damaged.bitc", damaged_file());
+	write_file("healthy.bit", "LINE NUMBER ZERO CODE PRINT ONE");
+	BitBatch batch(BitOptions(), 1);
+	batch.add("damaged.bitc", "");
+	batch.add("healthy.bit", "");
+	CHECK(!batch.run(), "the batch fails");
+	string output;
+	BitWriter writer(output);
+	batch.print(writer);
+	CHECK(output == "ERROR: The compiled file damaged.bitc is damaged or of another version.\n1\n", "batch output: " + output);
+}
+
+// The server answers a damaged file with an error and goes on with the next request.
+static void test_damaged_server() {
+	string damaged = damaged_file();
+	string healthy = "LINE NUMBER ZERO CODE PRINT ONE";
+	string requests = "RUN " + to_string(damaged.size()) + " 0\n" + damaged + "RUN " + to_string(healthy.size()) + " 0\n" + healthy;
+	FILE* input = tmpfile();
+	FILE* output = tmpfile();
+	CHECK(input != NULL && output != NULL, "temporary files are created");
+	if (input == NULL || output == NULL) {
+		return;
+	}
+	fwrite(requests.data(), 1, requests.size(), input);
+	rewind(input);
+	BitOptions options;
+	BitServer server(options);
+	server.serve(input, output);
+	fflush(output);
+	rewind(output);
+	string responses;
+	char buffer[256];
+	for (size_t count; (count = fread(buffer, 1, sizeof(buffer), output)) > 0; ) {
+		responses.append(buffer, count);
+	}
+	fclose(input);
+	fclose(output);
+	CHECK(responses.compare(0, 6, "ERROR ") == 0, "the damaged request fails: " + responses);
+	CHECK(responses.find("damaged or of another version.OK 1 ") != string::npos, "the next request runs: " + responses);
+}
+
+// Loops that print, with lines that don't print and a line before the loop, and a silent loop.
+static const string fast_forwarded_loops[] = {
+	"LINE NUMBER ZERO CODE PRINT ONE GOTO ONE LINE NUMBER ONE CODE PRINT ZERO GOTO ONE ZERO "
+		"LINE NUMBER ONE ZERO CODE VARIABLE ZERO EQUALS ONE GOTO ONE ONE LINE NUMBER ONE ONE CODE PRINT ONE GOTO ONE",
+	"LINE NUMBER ZERO CODE PRINT ZERO GOTO ONE LINE NUMBER ONE CODE PRINT ONE GOTO ZERO",
+	"LINE NUMBER ZERO CODE PRINT ONE GOTO ONE LINE NUMBER ONE CODE VARIABLE ZERO EQUALS ONE GOTO ONE",
+};
+
+// A loop that is fast-forwarded stops at the step limit on every backend, with the output of a run without detection.
+static void test_fast_forward_step_limit() {
+	for (const string& source : fast_forwarded_loops) {
+		for (uint64_t max_steps : { 1, 2, 3, 4, 5, 6, 7, 10, 23, 1000, 100001 }) {
+			for (const Backend& backend : backends()) {
+				BitOptions options = backend.options;
+				options.max_steps = max_steps;
+				string expected = run(source, options, "");
+				options.cycle_mode = CYCLES_FAST_FORWARDED;
+				string result = run(source, options, "");
+				CHECK(result == expected, "fast-forwarded loop with " + to_string(max_steps) + " steps on the " + backend.name + ": "
+					+ result.substr(0, 80) + " instead of " + expected.substr(0, 80));
+			}
+		}
+	}
+}
+
+// A loop that only prints stops with the step limit when it is fast-forwarded, with the bits a run without detection prints.
+static void test_fast_forward_print_loop() {
+	const string source = "LINE NUMBER ZERO CODE PRINT ONE GOTO ONE LINE NUMBER ONE CODE PRINT ZERO GOTO ZERO";
+	for (bool ascii : { false, true }) {
+		string outputs[2];
+		bool stopped[2] = { false, false };
+		for (CycleMode mode : { CYCLES_IGNORED, CYCLES_FAST_FORWARDED }) {
+			BitOptions options;
+			options.cycle_mode = mode;
+			options.max_steps = 12345;
+			options.print_ascii = ascii;
+			BitProgram program(parse(source, true), options);
+			string input;
+			BitReader reader(input.data(), input.data());
+			string& output = outputs[mode == CYCLES_FAST_FORWARDED];
+			BitWriter writer(output);
+			BitInterpreter interpreter(reader, writer, options);
+			try {
+				interpreter.run(program);
+			}
+			catch (const BitLimitError& error) {
+				stopped[mode == CYCLES_FAST_FORWARDED] = error.limit == LIMIT_STEPS;
+			}
+			writer.flush();
+		}
+		string mode = ascii ? "ascii " : "";
+		CHECK(stopped[0] && stopped[1], mode + "print loop stops with the step limit");
+		CHECK(outputs[0].size() == (ascii ? 12345 / 8 : 12345), mode + "print loop without detection prints a bit per line");
+		CHECK(outputs[1] == outputs[0], mode + "fast-forwarded print loop: " + outputs[1].substr(0, 80) + " instead of " + outputs[0].substr(0, 80));
+	}
+}
+
+// Runs that start from memory another program left check what typed stores put into the jump register.
+static void test_kept_memory() {
+	for (const Backend& backend : backends()) {
+		BitLiveProgram live(backend.options);
+		string output;
+		BitReader reader(output.data(), output.data());
+		BitWriter writer(output);
+		BitInterpreter interpreter(reader, writer, backend.options);
+		live.update(address_store.data(), address_store.data() + address_store.size());
+		live.run(interpreter);
+		live.update(jump_register_copy.data(), jump_register_copy.data() + jump_register_copy.size());
+		string error;
+		try {
+			live.run(interpreter);
+		}
+		catch (const BitError& failure) {
+			error = failure.what();
+		}
+		CHECK(error == address_error, string("live program on the ") + backend.name + ": " + (error.empty() ? "no error" : error));
+
+		BitProgram first(parse(address_store, true), backend.options);
+		BitProgram second(parse(jump_register_copy, true), backend.options);
+		BitSnapshot snapshot;
+		interpreter.run(first);
+		interpreter.save(snapshot);
+		error.clear();
+		try {
+			interpreter.run(second, snapshot);
+		}
+		catch (const BitError& failure) {
+			error = failure.what();
+		}
+		CHECK(error == address_error, string("snapshot on the ") + backend.name + ": " + (error.empty() ? "no error" : error));
+	}
+}
+
+// Bit constants, line numbers and addresses that don't fit into a value are syntax errors.
+static void test_long_constants() {
+	string zeros;
+	for (int i = 0; i < 32; i++) {
+		zeros += "ZERO ";
+	}
+	string ones29;
+	for (int i = 0; i < 29; i++) {
+		ones29 += "ONE ";
+	}
+	const string too_large[] = {
+		"LINE NUMBER ONE " + zeros + "CODE PRINT ONE GOTO ONE " + zeros,
+		"LINE NUMBER ZERO CODE PRINT ONE GOTO ONE " + zeros,
+		"LINE NUMBER ZERO CODE VARIABLE ONE " + zeros + "EQUALS ONE",
+		"LINE NUMBER ZERO CODE VARIABLE ONE EQUALS ONE " + zeros,
+		"LINE NUMBER ZERO CODE VARIABLE ONE EQUALS ONE " + ones29,
+	};
+	for (const string& source : too_large) {
+		string error;
+		try {
+			delete parse(source, true);
+		}
+		catch (const BitParserError& failure) {
+			error = failure.what();
+		}
+		CHECK(error.find("Bit constant is too large") == 0, source.substr(0, 60) + "...: " + (error.empty() ? "no error" : error));
+	}
+	string largest = "LINE NUMBER " + ones29 + "CODE VARIABLE " + ones29 + "EQUALS THE ADDRESS OF VARIABLE " + ones29;
+	try {
+		delete parse(largest, true);
+	}
+	catch (const BitParserError& failure) {
+		CHECK(false, string("the largest constants are accepted: ") + failure.what());
+	}
+	// Leading zeros don't count.
+	CHECK(run("LINE NUMBER ZERO CODE PRINT ONE GOTO " + zeros + "ONE LINE NUMBER ONE CODE PRINT ZERO", BitOptions(), "") == "10", "leading zeros");
+}
+
+// A saved trace decodes to the lines that ran last.
+static void test_trace() {
+#ifdef BIT_TRACING
+	string source = "LINE NUMBER ZERO CODE VARIABLE ONE EQUALS ONE GOTO ONE LINE NUMBER ONE CODE PRINT ONE GOTO ONE ZERO "
+		"LINE NUMBER ONE ZERO CODE THE JUMP REGISTER EQUALS VARIABLE ONE";
+	for (bool tree_walker : { false, true }) {
+		BitOptions options;
+		options.trace = true;
+		options.use_tree_walker = tree_walker;
+		BitProgram program(parse(source, true), options);
+		string output;
+		BitReader reader(output.data(), output.data());
+		BitWriter writer(output);
+		BitInterpreter interpreter(reader, writer, options);
+		BitTrace trace(2);
+		interpreter.trace = &trace;
+		interpreter.run(program);
+		CHECK(trace.save("trace.bitt", *program.code), "the trace is saved");
+		string data = read_file("trace.bitt");
+		BitTrace::Decoded decoded;
+		CHECK(decoded.load(data.data(), data.data() + data.size()), "the trace is loaded");
+		CHECK(decoded.skipped == 1 && decoded.entries.size() == 2, "the last two of three lines are kept");
+		if (decoded.entries.size() == 2) {
+			const BitTrace::Entry& print = decoded.entries[0];
+			const BitTrace::Entry& store = decoded.entries[1];
+			CHECK(decoded.line_numbers[print.line] == 1 && print.address == BitTrace::no_write, "the PRINT line writes nothing");
+			CHECK(decoded.line_numbers[store.line] == 2 && store.address == jump_register_address
+				&& Value{ store.value }.payload() == 1, "the last line stores one into the jump register");
+		}
+		CHECK(!decoded.load(data.data(), data.data() + data.size() - 1), "a truncated trace is rejected");
+	}
+#endif
+}
+
+#pragma endregion
+
+struct Test {
+	const char* name;
+	void(*run)();
+};
+
+static const Test tests[] = {
+	{ "backends", test_backends },
+	{ "bit_sliced", test_bit_sliced },
+	{ "compiled_round_trip", test_compiled_round_trip },
+	{ "compiled_cache", test_compiled_cache },
+	{ "damaged_compiled", test_damaged_compiled },
+	{ "damaged_batch", test_damaged_batch },
+	{ "damaged_server", test_damaged_server },
+	{ "fast_forward_print_loop", test_fast_forward_print_loop },
+	{ "fast_forward_step_limit", test_fast_forward_step_limit },
+	{ "kept_memory", test_kept_memory },
+	{ "long_constants", test_long_constants },
+	{ "trace", test_trace },
+};
+
+int main(int argc, char* argv[]) {
+	int ran = 0;
+	for (const Test& test : tests) {
+		if (argc < 2 || strcmp(argv[1], test.name) == 0) {
+			int before = failures;
+			test.run();
+			cout << (failures == before ? "PASSED " : "FAILED ") << test.name << "\n";
+			ran++;
+		}
+	}
+	if (ran == 0) {
+		cout << "No test is named " << argv[1] << ".\n";
+		return 1;
+	}
+	return failures == 0 ? 0 : 1;
+}